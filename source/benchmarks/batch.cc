@@ -0,0 +1,60 @@
+/**
+ * @brief Throughput of A_star::run_batch against the number of threads on a
+ *        fleet-like workload: many medium range queries on one random map.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    const std::uint32_t n = 1024;
+    const std::uint32_t queries = 2000;
+    const std::uint32_t reach = 64; // Max distance between start and target on each axis
+    const std::uint32_t capacity = 16 * reach;
+    const std::uint32_t threads[] = {1, 2, 4, 8};
+
+    A_star planner(n, n);
+    build_map(planner, map_kind::random, n);
+
+    std::mt19937 rng(n);
+    std::uniform_int_distribution<std::uint32_t> pos(reach, n - reach - 1);
+    std::uniform_int_distribution<std::uint32_t> off(0, 2 * reach);
+
+    std::vector<A_star::point> paths(std::size_t(queries) * capacity);
+    std::vector<A_star::query> batch;
+    while (batch.size() < queries)
+    {
+        // A blocked target would make the query flood the whole map
+        std::uint32_t sx = pos(rng), sy = pos(rng);
+        std::uint32_t tx = sx + off(rng) - reach, ty = sy + off(rng) - reach;
+        if (!planner.blocked(sx, sy) && !planner.blocked(tx, ty))
+            batch.push_back({sx, sy, tx, ty, &paths[batch.size() * capacity], capacity});
+    }
+    std::vector<A_star::result> results(queries);
+
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    std::printf("%-8s %10s %12s %14s %10s\n", "threads", "queries", "total ms", "queries/s", "speedup");
+    double base = 0;
+    for (std::uint32_t t : threads)
+    {
+        planner.set_threads(t);
+        planner.run_batch(batch.data(), results.data(), queries); // Warm up
+
+        bench_timer timer;
+        planner.run_batch(batch.data(), results.data(), queries);
+        double elapsed = timer.seconds();
+        if (t == 1)
+            base = elapsed;
+
+        std::printf("%-8u %10u %12.2f %14.0f %10.2f\n", t, queries, elapsed * 1e3, queries / elapsed, base / elapsed);
+    }
+
+    return 0;
+}
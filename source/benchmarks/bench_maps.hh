@@ -0,0 +1,95 @@
+/**
+ * @brief Test maps shared by the benchmark executables
+ */
+#ifndef BENCH_MAPS_H
+#define BENCH_MAPS_H
+
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+enum class map_kind
+{
+    open,
+    wall,
+    random,
+    maze
+};
+
+inline const char *map_name(map_kind kind)
+{
+    const char *names[] = {"open", "wall", "random", "maze"};
+    return names[int(kind)];
+}
+
+// Carves a perfect maze with an iterative randomized depth-first search, corridors on odd cells
+inline void carve_maze(A_star &planner, std::uint32_t n, std::uint32_t seed)
+{
+    for (std::uint32_t y = 0; y < n; y++)
+        for (std::uint32_t x = 0; x < n; x++)
+            planner.toggletile(x, y, false);
+
+    std::mt19937 rng(seed);
+    std::vector<std::uint32_t> stack = {1 + 1 * n};
+    planner.toggletile(1, 1, true);
+
+    const int dx[] = {2, -2, 0, 0};
+    const int dy[] = {0, 0, 2, -2};
+
+    while (!stack.empty())
+    {
+        std::uint32_t x = stack.back() % n, y = stack.back() / n;
+        int options[4], count = 0;
+        for (int d = 0; d < 4; d++)
+        {
+            std::int64_t nx = std::int64_t(x) + dx[d], ny = std::int64_t(y) + dy[d];
+            if (nx <= 0 || ny <= 0 || nx >= std::int64_t(n) - 1 || ny >= std::int64_t(n) - 1)
+                continue;
+            if (planner.blocked(std::uint32_t(nx), std::uint32_t(ny)))
+                options[count++] = d;
+        }
+
+        if (count == 0)
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        int d = options[rng() % count];
+        std::uint32_t nx = x + dx[d], ny = y + dy[d];
+        planner.toggletile(x + dx[d] / 2, y + dy[d] / 2, true);
+        planner.toggletile(nx, ny, true);
+        stack.push_back(nx + ny * n);
+    }
+}
+
+// Blocks about a fifth of the cells, keeping the corners (1, 1) and (last, last) free
+inline void scatter(A_star &planner, std::uint32_t n, std::uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uint32_t last = (n - 2) | 1;
+    for (std::uint32_t y = 0; y < n; y++)
+        for (std::uint32_t x = 0; x < n; x++)
+            if (rng() % 5 == 0 && !(x == 1 && y == 1) && !(x == last && y == last))
+                planner.toggletile(x, y, false);
+}
+
+/**
+ * @brief Fills an unblocked planner with one of the test maps. Queries from
+ *        (1, 1) to ((n - 2) | 1, (n - 2) | 1) are valid on all of them, the
+ *        maze only has corridors on odd cells.
+ */
+inline void build_map(A_star &planner, map_kind kind, std::uint32_t n)
+{
+    if (kind == map_kind::wall)
+        for (std::uint32_t y = 1; y < n; y++)
+            planner.toggletile(n / 2, y, false);
+    else if (kind == map_kind::random)
+        scatter(planner, n, n);
+    else if (kind == map_kind::maze)
+        carve_maze(planner, n, n);
+}
+
+#endif
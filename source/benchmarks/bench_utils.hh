@@ -0,0 +1,110 @@
+/**
+ * @brief Small helpers shared by the benchmark executables
+ */
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Wall clock stopwatch, started on construction
+ */
+class bench_timer
+{
+private:
+    std::chrono::steady_clock::time_point start;
+
+public:
+    bench_timer() : start(std::chrono::steady_clock::now()) {}
+
+    void reset() { start = std::chrono::steady_clock::now(); }
+
+    /**
+     * @returns Seconds elapsed since construction or the last reset
+     */
+    double seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+/**
+ * @brief Last level cache misses of the calling thread, read from the
+ *        hardware counters through perf_event_open (user space only).
+ *        Virtual machines and other platforms often have no such counter,
+ *        available() tells.
+ */
+class bench_misses
+{
+private:
+    int fd = -1;
+
+public:
+    bench_misses()
+    {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~bench_misses()
+    {
+#if defined(__linux__)
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+
+    bench_misses(const bench_misses &) = delete;
+    bench_misses &operator=(const bench_misses &) = delete;
+
+    bool available() const { return fd >= 0; }
+
+    void reset()
+    {
+#if defined(__linux__)
+        if (fd >= 0)
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+#endif
+    }
+
+    /**
+     * @returns Misses counted since construction or the last reset, 0 without a counter
+     */
+    std::uint64_t count() const
+    {
+        std::uint64_t value = 0;
+#if defined(__linux__)
+        if (fd >= 0 && read(fd, &value, sizeof(value)) != sizeof(value))
+            value = 0;
+#endif
+        return value;
+    }
+};
+
+/**
+ * @brief Keeps the compiler from optimizing a computed value away
+ */
+template <typename T>
+inline void bench_keep(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * @brief Nodes expanded and latency of bidirectional A_star::run, alternating
+ *        or on two threads, against the unidirectional search on long queries
+ *        across the test maps, with the number of queries whose path length
+ *        differs from the unidirectional one (always 0 when correct).
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main()
+{
+    const std::uint32_t n = 1024;
+    const std::uint32_t queries = 20;
+    const std::uint8_t modes[] = {A_STAR_BIDIR_OFF, A_STAR_BIDIR_ALTERNATE, A_STAR_BIDIR_THREADS};
+    const char *names[] = {"off", "alternate", "threads"};
+
+    std::printf("%-6s %-10s %12s %10s %10s\n", "map", "mode", "expanded", "ms", "mismatch");
+    for (map_kind kind : {map_kind::open, map_kind::wall, map_kind::random, map_kind::maze})
+    {
+        A_star planner(n, n);
+        build_map(planner, kind, n);
+
+        // Start and target in opposite quarters, on odd cells for the maze corridors
+        std::mt19937 rng(n);
+        std::vector<A_star::point> ends;
+        while (ends.size() < 2 * queries)
+        {
+            std::uint32_t x = (rng() % (n / 4)) | 1, y = (rng() % (n - 2)) | 1;
+            if (ends.size() % 2 == 1)
+                x = (n - 1 - x) | 1;
+            if (!planner.blocked(x, y))
+                ends.push_back({x, y});
+        }
+
+        std::vector<A_star::point> path(std::size_t(n) * n);
+        std::vector<std::uint32_t> lengths(queries);
+        for (std::uint32_t m = 0; m < 3; m++)
+        {
+            planner.set_bidirectional(modes[m]);
+
+            std::uint64_t expanded = 0;
+            std::uint32_t mismatch = 0;
+            bench_timer t;
+            for (std::uint32_t q = 0; q < queries; q++)
+            {
+                A_star::point s = ends[2 * q], g = ends[2 * q + 1];
+                std::uint32_t length = planner.run(s.x, s.y, g.x, g.y, path.data(), std::uint32_t(path.size()));
+                expanded += planner.expanded();
+
+                if (m == 0)
+                    lengths[q] = length;
+                else if (length != lengths[q])
+                    mismatch++;
+            }
+            double elapsed = t.seconds();
+
+            std::printf("%-6s %-10s %12.0f %10.3f %10u\n", map_name(kind), names[m], double(expanded) / queries,
+                        elapsed * 1e3 / queries, mismatch);
+        }
+    }
+
+    return 0;
+}
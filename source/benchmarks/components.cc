@@ -0,0 +1,103 @@
+/**
+ * @brief Connected component labels (see A_star::set_components): time to
+ *        label each test map, latency of a query whose target is walled
+ *        off with and without labels, and what keeping the labels up to
+ *        date adds to toggletile, for random toggles and for the worst
+ *        case of closing the only door between two halves of the map. A
+ *        cut too long to walk (a maze corridor) leaves the labels to the
+ *        next query, "next query ms" is that query after the toggles.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+int main()
+{
+    const std::uint32_t n = 2048;
+    const map_kind kinds[] = {map_kind::open, map_kind::random, map_kind::maze};
+
+    std::printf("%ux%u, %u hardware threads\n", n, n, std::thread::hardware_concurrency());
+    std::printf("%-8s %10s %16s %16s %14s %14s %14s\n", "map", "label ms", "walled off us", "labelled us", "toggle ns", "labelled ns", "next query ms");
+    for (map_kind kind : kinds)
+    {
+        A_star planner(n, n);
+        build_map(planner, kind, n);
+
+        // A closed room around the target, on odd cells so the maze keeps its corridors
+        std::uint32_t tx = (n / 2) | 1, ty = (n / 2) | 1;
+        for (std::uint32_t i = tx - 2; i <= tx + 2; i++)
+        {
+            planner.toggletile(i, ty - 2, false);
+            planner.toggletile(i, ty + 2, false);
+            planner.toggletile(tx - 2, i - tx + ty, false);
+            planner.toggletile(tx + 2, i - tx + ty, false);
+        }
+        planner.toggletile(tx, ty, true);
+
+        bench_timer t;
+        planner.run(1, 1, tx, ty);
+        double flooded = t.seconds();
+
+        t.reset();
+        planner.set_components(true);
+        double labelled = t.seconds();
+
+        const std::uint32_t queries = 1000;
+        t.reset();
+        for (std::uint32_t q = 0; q < queries; q++)
+            bench_keep(planner.run(1, 1, tx, ty));
+        double rejected = t.seconds() / queries;
+
+        // The same toggles twice, the second time undoing the first, without and with labels
+        const std::uint32_t toggles = 2000;
+        double cost[2];
+        for (std::uint32_t with = 0; with < 2; with++)
+        {
+            planner.set_components(with != 0);
+            std::mt19937 rng(n);
+            t.reset();
+            for (std::uint32_t i = 0; i < toggles; i++)
+            {
+                std::uint32_t x = rng() % n, y = rng() % n;
+                bool free = !planner.blocked(x, y);
+                planner.toggletile(x, y, !free);
+                planner.toggletile(x, y, free);
+            }
+            cost[with] = t.seconds() / (2 * toggles);
+        }
+
+        t.reset();
+        bench_keep(planner.run(1, 1, tx, ty));
+        double next = t.seconds();
+
+        std::printf("%-8s %10.2f %16.1f %16.3f %14.1f %14.1f %14.2f\n", map_name(kind), labelled * 1e3, flooded * 1e6,
+                    rejected * 1e6, cost[0] * 1e9, cost[1] * 1e9, next * 1e3);
+    }
+
+    // A wall down the middle with a single door: closing it splits the map, opening it joins it again
+    A_star planner(n, n);
+    build_map(planner, map_kind::wall, n);
+    planner.toggletile(n / 2, 0, false);
+    planner.toggletile(n / 2, n / 2, true);
+    planner.set_components(true);
+
+    const std::uint32_t doors = 3;
+    double closed = 0, opened = 0;
+    for (std::uint32_t i = 0; i < doors; i++)
+    {
+        bench_timer t;
+        planner.toggletile(n / 2, n / 2, false);
+        closed += t.seconds();
+        t.reset();
+        planner.toggletile(n / 2, n / 2, true);
+        opened += t.seconds();
+    }
+    std::printf("\ndoor between two %ux%u halves: closing %.2f ms, opening %.3f us\n", n / 2, n, closed / doors * 1e3,
+                opened / doors * 1e6);
+    return 0;
+}
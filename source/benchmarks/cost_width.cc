@@ -0,0 +1,58 @@
+/**
+ * @brief Cost of the search word width (A_STAR_COST_BITS): ns/exp on random
+ *        queries over the random test map with both open list backends, and
+ *        a serpentine corridor whose only path is longer than the 15 bit
+ *        g_cost of the default width allows. Build with
+ *        -DA_STAR_COST_BITS=32 to compare: the corridor is found then.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+int main()
+{
+    const std::uint32_t n = 1024;
+    const std::uint32_t queries = 200;
+    const char *queues[] = {"heap", "bucket"};
+
+    std::printf("cost bits: %d, search word: %u bytes/cell (%.1f MiB at %ux%u)\n", A_STAR_COST_BITS,
+                static_cast<unsigned>(sizeof(a_star_word)), double(sizeof(a_star_word)) * n * n / (1 << 20), n, n);
+
+    std::printf("%-8s %12s %10s\n", "queue", "expanded", "ns/exp");
+    for (std::uint8_t queue : {A_STAR_QUEUE_HEAP, A_STAR_QUEUE_BUCKET})
+    {
+        A_star planner(n, n);
+        build_map(planner, map_kind::random, n);
+        planner.set_queue(queue);
+
+        std::mt19937 rng(n);
+        std::uint64_t expanded = 0;
+        bench_timer t;
+        for (std::uint32_t q = 0; q < queries; q++)
+        {
+            planner.run(rng() % n, rng() % n, rng() % n, rng() % n);
+            expanded += planner.expanded();
+        }
+        double elapsed = t.seconds();
+        std::printf("%-8s %12llu %10.2f\n", queues[queue], static_cast<unsigned long long>(expanded),
+                    elapsed * 1e9 / expanded);
+    }
+
+    // Walls on every other row, open at alternate ends: about n / 2 * n moves
+    const std::uint32_t c = 300;
+    A_star corridor(c, c);
+    for (std::uint32_t y = 1; y < c; y += 2)
+        for (std::uint32_t x = 0; x < c; x++)
+            if (x != ((y / 2) % 2 == 0 ? c - 1 : 0))
+                corridor.toggletile(x, y, false);
+
+    bench_timer t;
+    std::uint32_t length = corridor.run(0, 0, 0, c - 1, nullptr, 0);
+    std::printf("corridor %ux%u: %s, length %u, %.2f ms\n", c, c, length != 0 ? "found" : "not found", length,
+                t.seconds() * 1e3);
+    return 0;
+}
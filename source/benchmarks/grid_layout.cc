@@ -0,0 +1,130 @@
+/**
+ * @brief Compares the former jagged map (one calloc per column) against the
+ *        contiguous row-major map: construction time, neighbor access and
+ *        nodes expanded per second by A_star::run.
+ */
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// Replica of the previous A_star::_loadmap / _freemap
+static std::uint32_t **jagged_load(std::uint32_t xs, std::uint32_t ys)
+{
+    std::uint32_t **map = static_cast<std::uint32_t **>(std::calloc(xs, sizeof(std::uint32_t *)));
+
+    for (std::uint32_t xi = 0; xi < xs; xi++)
+    {
+        map[xi] = static_cast<std::uint32_t *>(std::calloc(ys, sizeof(std::uint32_t)));
+
+        for (std::uint32_t yi = 0; yi < ys; yi++)
+            map[xi][yi] = A_STAR_NODE_ENABLED;
+    }
+    return map;
+}
+
+static void jagged_free(std::uint32_t **map, std::uint32_t xs)
+{
+    for (std::uint32_t xi = 0; xi < xs; xi++)
+        std::free(map[xi]);
+    std::free(map);
+}
+
+// Reads the 8 neighbors of every interior cell, which is what one expansion does to the map
+static std::uint64_t jagged_sweep(std::uint32_t **map, std::uint32_t xs, std::uint32_t ys)
+{
+    std::uint64_t acc = 0;
+    for (std::uint32_t y = 1; y + 1 < ys; y++)
+        for (std::uint32_t x = 1; x + 1 < xs; x++)
+            acc += map[x - 1][y - 1] + map[x][y - 1] + map[x + 1][y - 1] +
+                   map[x - 1][y] + map[x + 1][y] +
+                   map[x - 1][y + 1] + map[x][y + 1] + map[x + 1][y + 1];
+    return acc;
+}
+
+static std::uint64_t flat_sweep(const std::uint32_t *map, std::uint32_t xs, std::uint32_t ys, std::uint32_t stride)
+{
+    std::uint64_t acc = 0;
+    for (std::uint32_t y = 1; y + 1 < ys; y++)
+    {
+        const std::uint32_t *up = map + (y - 1) * stride;
+        const std::uint32_t *row = map + y * stride;
+        const std::uint32_t *down = map + (y + 1) * stride;
+        for (std::uint32_t x = 1; x + 1 < xs; x++)
+            acc += up[x - 1] + up[x] + up[x + 1] +
+                   row[x - 1] + row[x + 1] +
+                   down[x - 1] + down[x] + down[x + 1];
+    }
+    return acc;
+}
+
+static std::uint32_t *flat_load(std::uint32_t xs, std::uint32_t ys, std::uint32_t &stride)
+{
+    stride = (xs + 15) / 16 * 16;
+    std::uint32_t *map = static_cast<std::uint32_t *>(std::aligned_alloc(A_STAR_ALIGNMENT, std::size_t(stride) * ys * sizeof(std::uint32_t)));
+    for (std::size_t i = 0; i < std::size_t(stride) * ys; i++)
+        map[i] = A_STAR_NODE_ENABLED;
+    return map;
+}
+
+int main()
+{
+    const std::uint32_t sizes[] = {512, 1024, 2048, 4096};
+
+    std::printf("%-6s %14s %14s %16s %16s\n", "size", "jagged ms", "flat ms", "jagged Mcell/s", "flat Mcell/s");
+    for (std::uint32_t n : sizes)
+    {
+        // Best of a few constructions, first touch of fresh pages dominates otherwise
+        double jagged_build = 1e9, flat_build = 1e9;
+        std::uint32_t **jagged = nullptr;
+        for (int rep = 0; rep < 3; rep++)
+        {
+            if (jagged != nullptr)
+                jagged_free(jagged, n);
+
+            bench_timer t;
+            jagged = jagged_load(n, n);
+            jagged_build = std::min(jagged_build, t.seconds());
+
+            t.reset();
+            A_star *planner = new A_star(n, n);
+            flat_build = std::min(flat_build, t.seconds());
+            delete planner;
+        }
+
+        std::uint32_t stride;
+        std::uint32_t *flat = flat_load(n, n, stride);
+
+        bench_timer t;
+        bench_keep(jagged_sweep(jagged, n, n));
+        double jagged_scan = t.seconds();
+
+        t.reset();
+        bench_keep(flat_sweep(flat, n, n, stride));
+        double flat_scan = t.seconds();
+
+        double cells = double(n - 2) * (n - 2) / 1e6;
+        std::printf("%-6u %14.2f %14.2f %16.1f %16.1f\n", n, jagged_build * 1e3, flat_build * 1e3,
+                    cells / jagged_scan, cells / flat_scan);
+
+        jagged_free(jagged, n);
+        std::free(flat);
+    }
+
+    const std::uint32_t run_sizes[] = {128, 256, 512, 1024};
+
+    std::printf("\n%-6s %12s %12s %16s\n", "size", "expanded", "run ms", "nodes/s");
+    for (std::uint32_t n : run_sizes)
+    {
+        A_star planner(n, n);
+        bench_timer t;
+        planner.run(0, 0, n - 1, n - 1);
+        double elapsed = t.seconds();
+        std::printf("%-6u %12u %12.2f %16.0f\n", n, planner.expanded(), elapsed * 1e3, planner.expanded() / elapsed);
+    }
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * @brief Cost of one evaluation of every heuristic policy, inlined in a loop
+ *        over random offsets, then the search each one drives: expansions,
+ *        latency and path cost of A_star::run on long random queries.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+template <typename H>
+static void evaluate(const char *name, const std::vector<std::uint32_t> &offsets, std::uint32_t rounds)
+{
+    bench_timer t;
+    std::uint64_t sum = 0;
+    for (std::uint32_t r = 0; r < rounds; r++)
+        for (std::size_t i = 0; i < offsets.size(); i += 2)
+            sum += H::distance(offsets[i] + r, offsets[i + 1]);
+    double elapsed = t.seconds();
+    bench_keep(sum);
+
+    std::printf("%-10s %12.3f\n", name, elapsed * 1e9 / (double(rounds) * offsets.size() / 2));
+}
+
+// Cost of a path under the move prices of a policy
+static std::uint64_t path_cost(const std::vector<A_star::point> &path, std::uint32_t length, std::uint32_t straight,
+                               std::uint32_t diagonal)
+{
+    std::uint64_t cost = 0;
+    for (std::uint32_t i = 1; i < length; i++)
+        cost += path[i].x != path[i - 1].x && path[i].y != path[i - 1].y ? diagonal : straight;
+    return cost;
+}
+
+int main()
+{
+    const std::uint32_t n = 1024;
+    const std::uint32_t queries = 20;
+
+    std::mt19937 rng(n);
+    std::vector<std::uint32_t> offsets(2 << 16);
+    for (std::uint32_t &o : offsets)
+        o = rng() % n;
+
+    std::printf("%-10s %12s\n", "policy", "ns/eval");
+    evaluate<heuristic_chebyshev>("chebyshev", offsets, 200);
+    evaluate<heuristic_manhattan>("manhattan", offsets, 200);
+    evaluate<heuristic_octile>("octile", offsets, 200);
+    evaluate<heuristic_euclidean>("euclidean", offsets, 200);
+
+    A_star planner(n, n);
+    build_map(planner, map_kind::random, n);
+
+    // Start and target in opposite quarters, kept short enough for octile costs to fit in g_cost
+    std::vector<A_star::point> ends;
+    while (ends.size() < 2 * queries)
+    {
+        std::uint32_t x = rng() % (n / 4), y = rng() % n;
+        if (ends.size() % 2 == 1)
+            x = n / 2 + x;
+        if (!planner.blocked(x, y))
+            ends.push_back({x, y});
+    }
+
+    struct policy
+    {
+        const char *name;
+        std::uint8_t kind;
+        std::uint32_t straight, diagonal;
+    };
+    const policy policies[] = {{"chebyshev", A_STAR_HEURISTIC_CHEBYSHEV, heuristic_chebyshev::straight, heuristic_chebyshev::diagonal},
+                               {"manhattan", A_STAR_HEURISTIC_MANHATTAN, heuristic_manhattan::straight, heuristic_manhattan::diagonal},
+                               {"octile", A_STAR_HEURISTIC_OCTILE, heuristic_octile::straight, heuristic_octile::diagonal},
+                               {"euclidean", A_STAR_HEURISTIC_EUCLIDEAN, heuristic_euclidean::straight, heuristic_euclidean::diagonal}};
+
+    std::vector<A_star::point> path(std::size_t(n) * n);
+    std::printf("\n%-10s %12s %10s %10s %12s\n", "policy", "expanded", "ms", "length", "cost");
+    for (const policy &p : policies)
+    {
+        planner.set_heuristic(p.kind);
+
+        std::uint64_t expanded = 0, length = 0, cost = 0;
+        bench_timer t;
+        for (std::uint32_t q = 0; q < queries; q++)
+        {
+            A_star::point s = ends[2 * q], g = ends[2 * q + 1];
+            std::uint32_t l = planner.run(s.x, s.y, g.x, g.y, path.data(), std::uint32_t(path.size()));
+            expanded += planner.expanded();
+            length += l;
+            cost += path_cost(path, l, p.straight, p.diagonal);
+        }
+        double elapsed = t.seconds();
+
+        std::printf("%-10s %12.0f %10.3f %10.1f %12.1f\n", p.name, double(expanded) / queries, elapsed * 1e3 / queries,
+                    double(length) / queries, double(cost) / queries);
+    }
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * @brief Query latency of A_star::run_hierarchical against flat A_star::run
+ *        on long random queries, the cost of building the abstraction, the
+ *        extra length of hierarchical paths, and the latency of a query that
+ *        follows a toggletile (which rebuilds the clusters around the cell).
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main()
+{
+    const std::uint32_t sizes[] = {256, 1024, 2048};
+    const std::uint32_t cluster = 16;
+    const std::uint32_t queries = 20;
+
+    std::printf("%-6s %-6s %10s %10s %10s %10s %10s %10s %12s\n", "map", "size", "build ms", "flat ms", "flat max",
+                "hpa ms", "hpa max", "length", "update ms");
+    for (map_kind kind : {map_kind::open, map_kind::random})
+    {
+        for (std::uint32_t n : sizes)
+        {
+            A_star planner(n, n);
+            build_map(planner, kind, n);
+
+            // Long queries, start and target in opposite quarters of the map
+            std::mt19937 rng(n);
+            std::vector<A_star::point> ends;
+            while (ends.size() < 2 * queries)
+            {
+                std::uint32_t x = rng() % (n / 4), y = rng() % n;
+                if (ends.size() % 2 == 1)
+                    x = n - 1 - x;
+                if (!planner.blocked(x, y))
+                    ends.push_back({x, y});
+            }
+
+            bench_timer t;
+            planner.set_hierarchy(cluster);
+            double build = t.seconds();
+
+            std::vector<A_star::point> path(std::size_t(n) * n);
+            double flat = 0, flat_max = 0, hpa = 0, hpa_max = 0, ratio = 0;
+            std::uint32_t found = 0;
+            for (std::uint32_t q = 0; q < queries; q++)
+            {
+                A_star::point s = ends[2 * q], g = ends[2 * q + 1];
+
+                t.reset();
+                std::uint32_t optimal = planner.run(s.x, s.y, g.x, g.y, path.data(), std::uint32_t(path.size()));
+                double elapsed = t.seconds();
+                flat += elapsed;
+                flat_max = std::max(flat_max, elapsed);
+
+                t.reset();
+                std::uint32_t length = planner.run_hierarchical(s.x, s.y, g.x, g.y, path.data(), std::uint32_t(path.size()));
+                elapsed = t.seconds();
+                hpa += elapsed;
+                hpa_max = std::max(hpa_max, elapsed);
+
+                if (optimal != 0 && length != 0)
+                {
+                    ratio += double(length) / optimal;
+                    found++;
+                }
+            }
+
+            // Blocks a free cell and queries right away, then frees it again
+            double update = 0;
+            for (std::uint32_t q = 0; q < queries; q++)
+            {
+                A_star::point s = ends[2 * q], g = ends[2 * q + 1];
+                std::uint32_t x = rng() % n, y = rng() % n;
+                if (planner.blocked(x, y) || (x == s.x && y == s.y) || (x == g.x && y == g.y))
+                    continue;
+
+                t.reset();
+                planner.toggletile(x, y, false);
+                planner.run_hierarchical(s.x, s.y, g.x, g.y, path.data(), std::uint32_t(path.size()));
+                update += t.seconds();
+                planner.toggletile(x, y, true);
+            }
+
+            std::printf("%-6s %-6u %10.2f %10.3f %10.3f %10.3f %10.3f %10.4f %12.3f\n", map_name(kind), n, build * 1e3,
+                        flat / queries * 1e3, flat_max * 1e3, hpa / queries * 1e3, hpa_max * 1e3,
+                        found ? ratio / found : 0.0, update / queries * 1e3);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * @brief Replanning latency of A_star::run_incremental (D* Lite) against a
+ *        full A_star::run on a recorded drive: a robot crosses a random map
+ *        one cell per step while obstacles appear and vanish around it, as
+ *        a lidar would report them through toggletile.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// A recorded event: the robot moved to (x, y), or the cell (x, y) was toggled
+struct drive_event
+{
+    bool move;
+    std::uint32_t x, y;
+};
+
+/**
+ * @brief Records a drive on its own copy of the map: every step toggles a few
+ *        cells within sight of the robot, then moves it one cell along a
+ *        fresh shortest path
+ */
+static std::vector<drive_event> record(std::uint32_t n, A_star::point s, A_star::point g, std::uint32_t steps)
+{
+    const std::int32_t sight = 12;
+    A_star planner(n, n);
+    build_map(planner, map_kind::random, n);
+
+    std::mt19937 rng(n + 1);
+    std::uniform_int_distribution<std::int32_t> around(-sight, sight);
+    std::vector<A_star::point> path(std::size_t(n) * n);
+    std::vector<drive_event> events;
+
+    for (std::uint32_t step = 0; step < steps && (s.x != g.x || s.y != g.y); step++)
+    {
+        for (std::uint32_t k = 0; k < 4; k++)
+        {
+            std::int64_t x = std::int64_t(s.x) + around(rng), y = std::int64_t(s.y) + around(rng);
+            if (x < 0 || y < 0 || x >= n || y >= n || (x == s.x && y == s.y) || (x == g.x && y == g.y))
+                continue;
+            planner.toggletile(std::uint32_t(x), std::uint32_t(y), planner.blocked(std::uint32_t(x), std::uint32_t(y)));
+            events.push_back({false, std::uint32_t(x), std::uint32_t(y)});
+        }
+
+        if (planner.run(s.x, s.y, g.x, g.y, path.data(), std::uint32_t(path.size())) < 2)
+            break;
+        s = path[1];
+        events.push_back({true, s.x, s.y});
+    }
+
+    return events;
+}
+
+int main()
+{
+    const std::uint32_t sizes[] = {256, 512, 1024};
+    const std::uint32_t steps = 200;
+
+    std::printf("%-6s %8s %12s %12s %12s %12s %10s\n", "size", "replans", "full ms", "full exp", "lite ms",
+                "lite exp", "mismatch");
+    for (std::uint32_t n : sizes)
+    {
+        A_star full(n, n), lite(n, n);
+        build_map(full, map_kind::random, n);
+        build_map(lite, map_kind::random, n);
+
+        // From near one corner to near the other, on free cells
+        A_star::point s = {1, 1}, g = {n - 2, n - 2};
+        while (full.blocked(s.x, s.y))
+            s.x++;
+        while (full.blocked(g.x, g.y))
+            g.x--;
+        std::vector<drive_event> events = record(n, s, g, steps);
+
+        std::vector<A_star::point> path(std::size_t(n) * n);
+        const std::uint32_t capacity = std::uint32_t(path.size());
+        lite.run_incremental(s.x, s.y, g.x, g.y, path.data(), capacity); // Initial plan, not timed
+
+        double full_time = 0, lite_time = 0;
+        std::uint64_t full_expanded = 0, lite_expanded = 0;
+        std::uint32_t replans = 0, mismatch = 0;
+        for (const drive_event &e : events)
+        {
+            if (!e.move)
+            {
+                full.toggletile(e.x, e.y, full.blocked(e.x, e.y));
+                lite.toggletile(e.x, e.y, lite.blocked(e.x, e.y));
+                continue;
+            }
+
+            bench_timer t;
+            std::uint32_t expected = full.run(e.x, e.y, g.x, g.y, path.data(), capacity);
+            full_time += t.seconds();
+            full_expanded += full.expanded();
+
+            t.reset();
+            std::uint32_t length = lite.run_incremental(e.x, e.y, g.x, g.y, path.data(), capacity);
+            lite_time += t.seconds();
+            lite_expanded += lite.expanded();
+
+            replans++;
+            if (length != expected)
+                mismatch++;
+        }
+
+        replans = std::max<std::uint32_t>(replans, 1);
+        std::printf("%-6u %8u %12.3f %12.0f %12.3f %12.0f %10u\n", n, replans, full_time * 1e3 / replans,
+                    double(full_expanded) / replans, lite_time * 1e3 / replans, double(lite_expanded) / replans,
+                    mismatch);
+    }
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+/**
+ * @brief Cost of the cell index width (A_STAR_INDEX_BITS): ns/exp on random
+ *        queries over the random test map with both open list backends,
+ *        then local queries in the far corner of a map of more than 2^32
+ *        cells. 32-bit builds turn that map down; build with
+ *        -DA_STAR_INDEX_BITS=64 -DA_STAR_PACKED_GRID=ON to run it (its
+ *        bitmap is 500 MiB, its search buffers are only committed where
+ *        the queries go).
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <unistd.h>
+
+// Resident set size of the process, in MiB
+static double resident_mib()
+{
+    long pages = 0, resident = 0;
+    std::FILE *f = std::fopen("/proc/self/statm", "r");
+    if (f != nullptr)
+    {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2)
+            resident = 0;
+        std::fclose(f);
+    }
+    return double(resident) * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+}
+
+int main()
+{
+    const std::uint32_t n = 1024;
+    const std::uint32_t queries = 200;
+    const char *queues[] = {"heap", "bucket"};
+
+    std::printf("index bits: %d (%u bytes), grid: %s\n", A_STAR_INDEX_BITS, static_cast<unsigned>(sizeof(a_star_index)),
+                A_STAR_PACKED_GRID ? "packed" : "32 bits per cell");
+
+    std::printf("%-8s %12s %10s\n", "queue", "expanded", "ns/exp");
+    for (std::uint8_t queue : {A_STAR_QUEUE_HEAP, A_STAR_QUEUE_BUCKET})
+    {
+        A_star planner(n, n);
+        build_map(planner, map_kind::random, n);
+        planner.set_queue(queue);
+
+        std::mt19937 rng(n);
+        std::uint64_t expanded = 0;
+        bench_timer t;
+        for (std::uint32_t q = 0; q < queries; q++)
+        {
+            planner.run(rng() % n, rng() % n, rng() % n, rng() % n);
+            expanded += planner.expanded();
+        }
+        double elapsed = t.seconds();
+        std::printf("%-8s %12llu %10.2f\n", queues[queue], static_cast<unsigned long long>(expanded),
+                    elapsed * 1e9 / expanded);
+    }
+
+    // 66048 x 66048 cells, about 2^32.02: the last rows only have indices past 32 bits
+    const std::uint32_t huge = 66048, window = 256;
+    if (A_STAR_INDEX_BITS == 64 && !A_STAR_PACKED_GRID)
+    {
+        std::printf("huge map: skipped, 32-bit cells would take 16 GiB\n");
+        return 0;
+    }
+
+    double before = resident_mib();
+    A_star planner(huge, huge);
+    std::vector<A_star::point> path(4 * window);
+    if (!planner.run(huge - 1, huge - 1, huge - 2, huge - 2, path.data(), static_cast<std::uint32_t>(path.size())))
+    {
+        std::printf("huge map %ux%u: not supported by this build\n", huge, huge);
+        return 0;
+    }
+
+    std::mt19937 rng(7);
+    std::uint64_t expanded = 0, found = 0;
+    bench_timer t;
+    for (std::uint32_t q = 0; q < queries; q++)
+    {
+        std::uint32_t sx = huge - 1 - rng() % window, sy = huge - 1 - rng() % window;
+        std::uint32_t tx = huge - 1 - rng() % window, ty = huge - 1 - rng() % window;
+        found += planner.run(sx, sy, tx, ty, path.data(), static_cast<std::uint32_t>(path.size())) != 0;
+        expanded += planner.expanded();
+    }
+    double elapsed = t.seconds();
+    std::printf("huge map %ux%u: %llu/%u found, %.1f us/query, %.2f ns/exp, RSS %.0f MiB\n", huge, huge,
+                static_cast<unsigned long long>(found), queries, elapsed * 1e6 / queries, elapsed * 1e9 / expanded,
+                resident_mib() - before);
+    return 0;
+}
@@ -0,0 +1,68 @@
+/**
+ * @brief Plain A* against jump point search (A_star::set_expansion): nodes
+ *        expanded and wall time over random queries on each test map. Both
+ *        modes must return paths of the same length, mismatches are counted.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main()
+{
+    const std::uint32_t sizes[] = {256, 1024};
+    const std::uint32_t queries = 50;
+    const char *modes[] = {"astar", "jps"};
+
+    std::printf("%-6s %-6s %-6s %8s %14s %12s %10s\n", "map", "size", "mode", "queries", "expanded", "total ms",
+                "mismatch");
+    for (map_kind kind : {map_kind::open, map_kind::wall, map_kind::random, map_kind::maze})
+    {
+        for (std::uint32_t n : sizes)
+        {
+            A_star planner(n, n);
+            build_map(planner, kind, n);
+
+            // The same free start and target pairs for both modes, the maze only has corridors on odd cells
+            std::mt19937 rng(n);
+            std::vector<A_star::point> ends;
+            while (ends.size() < 2 * queries)
+            {
+                std::uint32_t x = (rng() % (n - 2)) | 1, y = (rng() % (n - 2)) | 1;
+                if (!planner.blocked(x, y))
+                    ends.push_back({x, y});
+            }
+
+            std::vector<A_star::point> path(std::size_t(n) * n);
+            std::vector<std::uint32_t> lengths[2];
+            std::uint64_t expanded[2] = {0, 0};
+            double elapsed[2];
+            for (std::uint8_t mode : {A_STAR_EXPAND_ALL, A_STAR_EXPAND_JPS})
+            {
+                planner.set_expansion(mode);
+                bench_timer t;
+                for (std::uint32_t q = 0; q < queries; q++)
+                {
+                    A_star::point s = ends[2 * q], g = ends[2 * q + 1];
+                    lengths[mode].push_back(planner.run(s.x, s.y, g.x, g.y, path.data(), std::uint32_t(path.size())));
+                    expanded[mode] += planner.expanded();
+                }
+                elapsed[mode] = t.seconds();
+            }
+
+            std::uint32_t mismatch = 0;
+            for (std::uint32_t q = 0; q < queries; q++)
+                mismatch += lengths[0][q] != lengths[1][q];
+
+            for (std::uint8_t mode : {A_STAR_EXPAND_ALL, A_STAR_EXPAND_JPS})
+                std::printf("%-6s %-6u %-6s %8u %14llu %12.2f %10u\n", map_name(kind), n, modes[mode], queries,
+                            static_cast<unsigned long long>(expanded[mode]), elapsed[mode] * 1e3, mismatch);
+        }
+    }
+
+    return 0;
+}
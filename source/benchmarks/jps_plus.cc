@@ -0,0 +1,83 @@
+/**
+ * @brief JPS+ jump tables (A_STAR_EXPAND_JPS_PLUS) against plain jump point
+ *        search: time and memory spent building the tables, query time over
+ *        the same random queries, and the cost of keeping the tables in sync
+ *        through toggletile compared with building them again.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main()
+{
+    const std::uint32_t sizes[] = {256, 1024};
+    const std::uint32_t queries = 50;
+    const std::uint32_t toggles = 200;
+
+    std::printf("%-6s %-6s %10s %10s %10s %10s %10s %12s %10s\n", "map", "size", "build ms", "map MB", "table MB",
+                "jps ms", "jps+ ms", "update us", "mismatch");
+    for (map_kind kind : {map_kind::open, map_kind::wall, map_kind::random, map_kind::maze})
+    {
+        for (std::uint32_t n : sizes)
+        {
+            A_star planner(n, n);
+            build_map(planner, kind, n);
+
+            std::mt19937 rng(n);
+            std::vector<A_star::point> ends;
+            while (ends.size() < 2 * queries)
+            {
+                std::uint32_t x = (rng() % (n - 2)) | 1, y = (rng() % (n - 2)) | 1;
+                if (!planner.blocked(x, y))
+                    ends.push_back({x, y});
+            }
+
+            bench_timer t;
+            planner.set_expansion(A_STAR_EXPAND_JPS_PLUS);
+            double build = t.seconds();
+
+            std::vector<A_star::point> path(std::size_t(n) * n);
+            std::vector<std::uint32_t> lengths[2];
+            double elapsed[2];
+            const std::uint8_t modes[] = {A_STAR_EXPAND_JPS, A_STAR_EXPAND_JPS_PLUS};
+            for (int m = 0; m < 2; m++)
+            {
+                planner.set_expansion(modes[m]);
+                t.reset();
+                for (std::uint32_t q = 0; q < queries; q++)
+                {
+                    A_star::point s = ends[2 * q], g = ends[2 * q + 1];
+                    lengths[m].push_back(planner.run(s.x, s.y, g.x, g.y, path.data(), std::uint32_t(path.size())));
+                }
+                elapsed[m] = t.seconds();
+            }
+
+            std::uint32_t mismatch = 0;
+            for (std::uint32_t q = 0; q < queries; q++)
+                mismatch += lengths[0][q] != lengths[1][q];
+
+            // Each cell is flipped and flipped back, both changes update the tables
+            t.reset();
+            for (std::uint32_t i = 0; i < toggles; i++)
+            {
+                std::uint32_t x = rng() % n, y = rng() % n;
+                bool state = planner.blocked(x, y);
+                planner.toggletile(x, y, state);
+                planner.toggletile(x, y, !state);
+            }
+            double update = t.seconds() / (2 * toggles);
+
+            // One 32 bit word per cell for the map, 8 of them for the tables
+            double map = double(n) * n * sizeof(std::uint32_t) / (1 << 20);
+            std::printf("%-6s %-6u %10.2f %10.1f %10.1f %10.2f %10.2f %12.2f %10u\n", map_name(kind), n, build * 1e3,
+                        map, 8 * map, elapsed[0] * 1e3, elapsed[1] * 1e3, update * 1e6, mismatch);
+        }
+    }
+
+    return 0;
+}
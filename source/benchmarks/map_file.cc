@@ -0,0 +1,66 @@
+/**
+ * @brief Planner startup from a binary map file (see A_star::save) against
+ *        building the same map one toggletile call per cell, as a loader
+ *        reading any other format has to. Packed builds (A_STAR_PACKED_GRID)
+ *        map the file in place; the first query, a local one, then pays for
+ *        the pages it reads.
+ */
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "bench_map_file.map";
+    // 16384 x 16384 takes a GiB with 32-bit cells, only run it packed
+    const std::uint32_t sizes[] = {1024, 4096, A_STAR_PACKED_GRID ? 16384u : 8192u};
+
+    std::printf("grid: %s\n", A_STAR_PACKED_GRID ? "packed, file mapped in place" : "32 bits per cell, file expanded on load");
+    std::printf("%-7s %14s %14s %14s %12s\n", "size", "per cell ms", "from file ms", "first query ms", "file MiB");
+
+    for (std::uint32_t n : sizes)
+    {
+        // A fifth of the cells blocked, drawn once so both loaders build the same map
+        std::mt19937 rng(n);
+        std::vector<std::uint8_t> cells(std::size_t(n) * n);
+        for (std::uint8_t &cell : cells)
+            cell = rng() % 5 == 0;
+        // The query runs between the corners of a 256 cell window
+        cells[std::size_t(n) + 1] = 0;
+        cells[std::size_t(256) * n + 256] = 0;
+
+        bench_timer t;
+        {
+            A_star planner(n, n);
+            for (std::uint32_t y = 0; y < n; y++)
+                for (std::uint32_t x = 0; x < n; x++)
+                    planner.toggletile(x, y, cells[std::size_t(y) * n + x] == 0);
+            bench_keep(planner);
+            if (!planner.save(path))
+                return 1;
+        }
+        double per_cell = t.seconds();
+
+        std::FILE *file = std::fopen(path, "rb");
+        std::fseek(file, 0, SEEK_END);
+        double file_mib = double(std::ftell(file)) / (1024.0 * 1024.0);
+        std::fclose(file);
+
+        t.reset();
+        A_star planner(path);
+        double from_file = t.seconds();
+
+        t.reset();
+        bench_keep(planner.run(1, 1, 256, 256));
+        double first_query = t.seconds();
+
+        std::printf("%-7u %14.2f %14.3f %14.2f %12.1f\n", n, per_cell * 1e3, from_file * 1e3, first_query * 1e3, file_mib);
+    }
+
+    std::remove(path);
+    return 0;
+}
@@ -0,0 +1,31 @@
+/**
+ * @brief Expansion time of A_star::run as the map grows. A wall with a single
+ *        gap at the top, away from the target, forces the search to flood most
+ *        of the map, so the open list gets large and membership tests dominate.
+ */
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+
+int main()
+{
+    const std::uint32_t sizes[] = {64, 128, 256, 512, 1024, 2048};
+
+    std::printf("%-6s %12s %12s %14s\n", "size", "expanded", "run ms", "ns/expansion");
+    for (std::uint32_t n : sizes)
+    {
+        A_star planner(n, n);
+        for (std::uint32_t y = 1; y < n; y++)
+            planner.toggletile(n / 2, y, false);
+
+        bench_timer t;
+        planner.run(0, 0, n - 1, n - 1);
+        double elapsed = t.seconds();
+        std::printf("%-6u %12u %12.2f %14.1f\n", n, planner.expanded(), elapsed * 1e3,
+                    elapsed * 1e9 / planner.expanded());
+    }
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * @brief Memory and query cost of the obstacle grid as built (see
+ *        A_STAR_PACKED_GRID), on open maps of growing size. Queries stay
+ *        within a small window, so the resident size shows what the
+ *        planner commits for the map itself and for the scratch space a
+ *        local search actually touches.
+ */
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <unistd.h>
+
+// Resident set size of the process, in MiB
+static double resident_mib()
+{
+    long pages = 0, resident = 0;
+    std::FILE *f = std::fopen("/proc/self/statm", "r");
+    if (f != nullptr)
+    {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2)
+            resident = 0;
+        std::fclose(f);
+    }
+    return double(resident) * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+}
+
+int main()
+{
+    const std::uint32_t queries = 200;
+    const std::uint32_t window = 256;
+    // 16384 x 16384 takes a GiB with 32-bit cells, only run it packed
+    const std::uint32_t sizes[] = {1024, 4096, A_STAR_PACKED_GRID ? 16384u : 8192u};
+
+    std::printf("grid: %s\n", A_STAR_PACKED_GRID ? "packed, 1 bit per cell" : "32 bits per cell");
+    std::printf("%-7s %12s %14s %14s %12s\n", "size", "map MiB", "built RSS MiB", "query RSS MiB", "us/query");
+
+    for (std::uint32_t n : sizes)
+    {
+        double before = resident_mib();
+        A_star planner(n, n);
+        double built = resident_mib() - before;
+        double cells = double(n) * n;
+        double map_mib = (A_STAR_PACKED_GRID ? cells / 8 : cells * 4) / (1024.0 * 1024.0);
+
+        // A few walls around the middle so the searches expand more than a straight line
+        std::uint32_t mid = n / 2;
+        for (std::uint32_t i = 0; i < window; i += 8)
+            for (std::uint32_t j = 0; j < window - 16; j++)
+                planner.toggletile(mid - window / 2 + i, mid - window / 2 + j + (i & 8 ? 16 : 0), false);
+
+        std::mt19937 rng(7);
+        std::vector<A_star::point> path(4 * window);
+        bench_timer t;
+        for (std::uint32_t q = 0; q < queries; q++)
+        {
+            // A blocked endpoint would send the search across the whole map
+            std::uint32_t sx, sy, tx, ty;
+            do
+            {
+                sx = mid - window / 2 + rng() % window;
+                sy = mid - window / 2 + rng() % window;
+            } while (planner.blocked(sx, sy));
+            do
+            {
+                tx = mid - window / 2 + rng() % window;
+                ty = mid - window / 2 + rng() % window;
+            } while (planner.blocked(tx, ty));
+            bench_keep(planner.run(sx, sy, tx, ty, path.data(), std::uint32_t(path.size())));
+        }
+        double elapsed = t.seconds();
+
+        std::printf("%-7u %12.1f %14.1f %14.1f %12.1f\n", n, map_mib, built, resident_mib() - before,
+                    elapsed * 1e6 / queries);
+    }
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * @brief Binary heap against bucket queue open lists (A_star::set_queue) on
+ *        an open map, a walled map and a maze.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+
+int main()
+{
+    const std::uint32_t sizes[] = {256, 1024};
+
+    std::printf("%-6s %-6s %-8s %12s %12s\n", "map", "size", "queue", "expanded", "run ms");
+    for (map_kind kind : {map_kind::open, map_kind::wall, map_kind::maze})
+    {
+        for (std::uint32_t n : sizes)
+        {
+            A_star planner(n, n);
+            double elapsed[2];
+            std::uint32_t expanded[2];
+            build_map(planner, kind, n);
+
+            // The maze only has corridors on odd cells
+            std::uint32_t last = (n - 2) | 1;
+            for (std::uint8_t queue : {A_STAR_QUEUE_HEAP, A_STAR_QUEUE_BUCKET})
+            {
+                planner.set_queue(queue);
+                planner.run(1, 1, last, last); // Warm up
+
+                bench_timer t;
+                planner.run(1, 1, last, last);
+                elapsed[queue] = t.seconds();
+                expanded[queue] = planner.expanded();
+            }
+
+            std::printf("%-6s %-6u %-8s %12u %12.2f\n", map_name(kind), n, "heap", expanded[0], elapsed[0] * 1e3);
+            std::printf("%-6s %-6u %-8s %12u %12.2f\n", map_name(kind), n, "bucket", expanded[1], elapsed[1] * 1e3);
+        }
+    }
+
+    return 0;
+}
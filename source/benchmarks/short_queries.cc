@@ -0,0 +1,133 @@
+/**
+ * @brief Many short A_star::run queries in a row on the same planner. With
+ *        generation stamped search state the cost of a query should not
+ *        depend on the size of the map, and a warmed up planner should not
+ *        request any memory from the system: "arena" counts the blocks the
+ *        arenas ask for, "heap" every heap allocation of the process made
+ *        while the queries run (malloc and friends on glibc, which operator
+ *        new and the containers go through too; operator new elsewhere).
+ */
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+#include "pathfinder/arena.hh"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+// Heap allocations of the whole process, counted by the replacements below
+static std::atomic<std::uint64_t> heap_allocations{0};
+
+static void count_allocation()
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+// Defined here, they take the place of the C library's for the executable and everything it links
+extern "C"
+{
+    void *__libc_malloc(std::size_t size);
+    void *__libc_calloc(std::size_t count, std::size_t size);
+    void *__libc_realloc(void *old, std::size_t size);
+    void *__libc_memalign(std::size_t alignment, std::size_t size);
+
+    void *malloc(std::size_t size) noexcept
+    {
+        count_allocation();
+        return __libc_malloc(size);
+    }
+
+    void *calloc(std::size_t count, std::size_t size) noexcept
+    {
+        count_allocation();
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *old, std::size_t size) noexcept
+    {
+        count_allocation();
+        return __libc_realloc(old, size);
+    }
+
+    void *memalign(std::size_t alignment, std::size_t size) noexcept
+    {
+        count_allocation();
+        return __libc_memalign(alignment, size);
+    }
+
+    void *aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+    {
+        count_allocation();
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void **out, std::size_t alignment, std::size_t size) noexcept
+    {
+        count_allocation();
+        *out = __libc_memalign(alignment, size);
+        return *out == nullptr ? ENOMEM : 0;
+    }
+}
+#else
+void *operator new(std::size_t size)
+{
+    count_allocation();
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+#endif
+
+int main()
+{
+    const std::uint32_t sizes[] = {256, 1024, 4096};
+    const std::uint32_t queries = 20000;
+    const std::uint32_t reach = 24; // Max distance between start and target on each axis
+
+    std::printf("%-6s %10s %12s %12s %14s %8s %8s\n", "size", "queries", "expanded", "total ms", "us/query", "arena", "heap");
+    for (std::uint32_t n : sizes)
+    {
+        A_star planner(n, n);
+        std::mt19937 rng(n);
+        std::uniform_int_distribution<std::uint32_t> pos(reach, n - reach - 1);
+        std::uniform_int_distribution<std::uint32_t> off(0, 2 * reach);
+
+        std::uint64_t expanded = 0;
+        std::uint64_t allocs = arena::allocations(), heap = heap_allocations.load();
+        bench_timer t;
+        for (std::uint32_t q = 0; q < queries; q++)
+        {
+            std::uint32_t sx = pos(rng), sy = pos(rng);
+            planner.run(sx, sy, sx + off(rng) - reach, sy + off(rng) - reach);
+            expanded += planner.expanded();
+        }
+        double elapsed = t.seconds();
+        allocs = arena::allocations() - allocs;
+        heap = heap_allocations.load() - heap;
+        std::printf("%-6u %10u %12llu %12.2f %14.2f %8llu %8llu\n", n, queries, static_cast<unsigned long long>(expanded),
+                    elapsed * 1e3, elapsed * 1e6 / queries, static_cast<unsigned long long>(allocs),
+                    static_cast<unsigned long long>(heap));
+    }
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * @brief Cost of one plain A* expansion with every neighbor expansion kernel
+ *        (see A_star::set_simd), in TSC cycles and nanoseconds, on long
+ *        queries across the test maps. A_STAR_SIMD_OFF is the check_node
+ *        path every expansion took before the kernels.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static std::uint64_t cycles() { return __rdtsc(); }
+#else
+static std::uint64_t cycles() { return 0; }
+#endif
+
+int main()
+{
+    const std::uint32_t n = 1024;
+    const std::uint32_t rounds = 5;
+    const std::uint8_t levels[] = {A_STAR_SIMD_OFF, A_STAR_SIMD_SCALAR, A_STAR_SIMD_SSE4, A_STAR_SIMD_AVX2};
+    const char *names[] = {"off", "scalar", "sse4", "avx2"};
+
+    std::printf("%-6s %-8s %12s %12s %12s\n", "map", "kernel", "expanded", "cycles/exp", "ns/exp");
+    for (map_kind kind : {map_kind::open, map_kind::random, map_kind::maze})
+    {
+        A_star planner(n, n);
+        build_map(planner, kind, n);
+        const std::uint32_t far = (n - 2) | 1;
+
+        for (std::uint32_t l = 0; l < 4; l++)
+        {
+            if (!planner.set_simd(levels[l]))
+                continue;
+
+            planner.run(1, 1, far, far); // Warm up
+            std::uint64_t expanded = 0, start = cycles();
+            bench_timer t;
+            for (std::uint32_t r = 0; r < rounds; r++)
+            {
+                planner.run(1, 1, far, far);
+                expanded += planner.expanded();
+            }
+            double elapsed = t.seconds();
+            std::uint64_t spent = cycles() - start;
+
+            std::printf("%-6s %-8s %12.0f %12.1f %12.2f\n", map_name(kind), names[l], double(expanded) / rounds,
+                        double(spent) / expanded, elapsed * 1e9 / expanded);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+/**
+ * @brief Search statistics (see A_star::last_stats) over random queries on
+ *        the random test map, aggregated in a stats_histogram. Build with
+ *        -DA_STAR_STATS=OFF to see what the counters cost: only ns/exp
+ *        and expansions remain then. The histograms go to the JSON file
+ *        given as first argument, if any.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+#include "pathfinder/stats.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+int main(int argc, char **argv)
+{
+    const std::uint32_t n = 1024;
+    const std::uint32_t queries = 400;
+
+    A_star planner(n, n);
+    build_map(planner, map_kind::random, n);
+
+    std::mt19937 rng(n);
+    stats_histogram histogram;
+    std::uint64_t expanded = 0;
+    bench_timer t;
+    for (std::uint32_t q = 0; q < queries; q++)
+    {
+        planner.run(rng() % n, rng() % n, rng() % n, rng() % n);
+        histogram.add(planner.last_stats());
+        expanded += planner.expanded();
+    }
+    double elapsed = t.seconds();
+
+    std::printf("stats: %s, %u queries, %.2f ns/exp\n", A_STAR_STATS ? "on" : "off", queries, elapsed * 1e9 / expanded);
+    std::printf("%-12s %12s %12s %12s %12s\n", "metric", "p50", "p90", "p99", "max");
+    const char *names[] = {"latency_ns", "expanded", "pushed", "peak_open"};
+    for (std::uint32_t m = 0; m < stats_histogram::metrics; m++)
+    {
+        stats_histogram::metric k = static_cast<stats_histogram::metric>(m);
+        std::printf("%-12s %12llu %12llu %12llu %12llu\n", names[m],
+                    static_cast<unsigned long long>(histogram.percentile(k, 0.5)),
+                    static_cast<unsigned long long>(histogram.percentile(k, 0.9)),
+                    static_cast<unsigned long long>(histogram.percentile(k, 0.99)),
+                    static_cast<unsigned long long>(histogram.max(k)));
+    }
+
+    if (argc > 1)
+    {
+        std::FILE *out = std::fopen(argv[1], "w");
+        if (out == nullptr)
+            return 1;
+        histogram.export_json(out);
+        std::fclose(out);
+    }
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+/**
+ * @brief Cost of terrain costs (see A_star::set_cost) on long queries across
+ *        the test maps: "uniform" has no cost plane and runs as before,
+ *        "plane" has one where every cell still costs 1, and "zones" has
+ *        slow patches covering about a quarter of the map.
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+int main()
+{
+    const std::uint32_t n = 1024;
+    const std::uint32_t rounds = 5;
+    const char *layers[] = {"uniform", "plane", "zones"};
+
+    std::printf("%-6s %-8s %10s %12s %12s %10s\n", "map", "costs", "length", "expanded", "ms/query", "ns/exp");
+    for (map_kind kind : {map_kind::open, map_kind::wall, map_kind::random})
+    {
+        const std::uint32_t far = (n - 2) | 1;
+
+        for (std::uint32_t layer = 0; layer < 3; layer++)
+        {
+            A_star planner(n, n);
+            build_map(planner, kind, n);
+
+            if (layer == 1)
+            {
+                // Allocates the plane, then puts the only cost back to 1
+                planner.set_cost(0, 0, 2);
+                planner.set_cost(0, 0, 1);
+            }
+            else if (layer == 2)
+            {
+                std::mt19937 rng(n);
+                for (std::uint32_t patch = 0; patch < 64; patch++)
+                {
+                    std::uint32_t px = rng() % (n - 64), py = rng() % (n - 64);
+                    std::uint8_t cost = static_cast<std::uint8_t>(2 + rng() % 4);
+                    for (std::uint32_t y = py; y < py + 64; y++)
+                        for (std::uint32_t x = px; x < px + 64; x++)
+                            planner.set_cost(x, y, cost);
+                }
+            }
+
+            std::uint32_t length = planner.run(1, 1, far, far, nullptr, 0); // Warm up
+            std::uint64_t expanded = 0;
+            bench_timer t;
+            for (std::uint32_t r = 0; r < rounds; r++)
+            {
+                planner.run(1, 1, far, far);
+                expanded += planner.expanded();
+            }
+            double elapsed = t.seconds();
+
+            std::printf("%-6s %-8s %10u %12.0f %12.2f %10.2f\n", map_name(kind), layers[layer], length,
+                        double(expanded) / rounds, elapsed * 1e3 / rounds, elapsed * 1e9 / expanded);
+        }
+    }
+
+    return 0;
+}
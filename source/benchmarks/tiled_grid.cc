@@ -0,0 +1,161 @@
+/**
+ * @brief Row-major against tiled cell numbering (see A_STAR_TILED_GRID).
+ *        First a replica of both layouts in this one executable: cache
+ *        lines the 3x3 window of an expansion spans in a plane of 32 bit
+ *        cells, then the neighbor reads of a wavefront sweeping the map
+ *        ring by ring, the way a search on an open floor grows. Then
+ *        A_star::run itself, in the layout this executable was built with:
+ *        build it again with -DA_STAR_TILED_GRID=ON (or OFF) to compare.
+ *        Cache misses come from the hardware counters, "n/a" where the
+ *        platform has none (most virtual machines).
+ */
+#include "benchmarks/bench_maps.hh"
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Replica of A_star::_index in both layouts, stride a multiple of the tile side
+static std::uint64_t row_index(std::uint32_t x, std::uint32_t y, std::uint32_t stride)
+{
+    return std::uint64_t(y) * stride + x;
+}
+
+static std::uint64_t tile_index(std::uint32_t x, std::uint32_t y, std::uint32_t stride)
+{
+    const std::uint32_t low = A_STAR_TILE - 1;
+    return ((std::uint64_t(y >> A_STAR_TILE_SHIFT) * stride + (x & ~low) + (y & low)) << A_STAR_TILE_SHIFT) | (x & low);
+}
+
+typedef std::uint64_t (*index_fn)(std::uint32_t, std::uint32_t, std::uint32_t);
+
+// Average number of distinct cache lines holding the 3x3 window of an interior cell, 4 bytes a cell
+static double window_lines(index_fn index, std::uint32_t n)
+{
+    std::uint64_t total = 0, windows = 0;
+    for (std::uint32_t y = 1; y + 1 < n; y++)
+        for (std::uint32_t x = 1; x + 1 < n; x++)
+        {
+            std::uint64_t lines[9];
+            std::uint32_t k = 0;
+            for (std::uint32_t dy = 0; dy < 3; dy++)
+                for (std::uint32_t dx = 0; dx < 3; dx++)
+                    lines[k++] = index(x + dx - 1, y + dy - 1, n) * sizeof(std::uint32_t) / A_STAR_ALIGNMENT;
+            std::sort(lines, lines + 9);
+            total += std::unique(lines, lines + 9) - lines;
+            windows++;
+        }
+    return double(total) / windows;
+}
+
+// Interior cells by Chebyshev distance from the middle, ring by ring, as a search on an open floor reaches them
+static std::vector<std::uint32_t> wavefront(std::uint32_t n)
+{
+    std::vector<std::uint32_t> order;
+    order.reserve(std::size_t(n) * n);
+    std::int64_t c = n / 2;
+    for (std::int64_t r = 0; r < c; r++)
+        for (std::int64_t y = c - r; y <= c + r; y++)
+        {
+            // Whole rows at the top and bottom of the ring, its two ends on the rows between
+            std::int64_t step = (y == c - r || y == c + r) ? 1 : std::max<std::int64_t>(2 * r, 1);
+            for (std::int64_t x = c - r; x <= c + r; x += step)
+                if (x > 0 && y > 0 && x + 1 < n && y + 1 < n)
+                    order.push_back(static_cast<std::uint32_t>(y) * n + static_cast<std::uint32_t>(x));
+        }
+    return order;
+}
+
+// Reads the 8 neighbors and stamps every cell of the order, like an expansion reads and writes the search planes
+static std::uint64_t sweep(std::uint32_t *plane, index_fn index, const std::vector<std::uint32_t> &order, std::uint32_t n)
+{
+    std::uint64_t acc = 0;
+    for (std::uint32_t cell : order)
+    {
+        std::uint32_t x = cell % n, y = cell / n;
+        for (std::uint32_t dy = 0; dy < 3; dy++)
+            for (std::uint32_t dx = 0; dx < 3; dx++)
+                acc += plane[index(x + dx - 1, y + dy - 1, n)];
+        plane[index(x, y, n)] = static_cast<std::uint32_t>(acc);
+    }
+    return acc;
+}
+
+static void print_misses(const bench_misses &misses, std::uint64_t count, double per)
+{
+    if (misses.available())
+        std::printf(" %12.2f\n", double(count) / per);
+    else
+        std::printf(" %12s\n", "n/a");
+}
+
+int main()
+{
+    const char *layouts[] = {"row-major", "tiled"};
+    const index_fn indices[] = {&row_index, &tile_index};
+    bench_misses misses;
+
+    std::printf("replica, %ux%u tiles, 4 byte cells\n", A_STAR_TILE, A_STAR_TILE);
+    std::printf("%-10s %6s %12s %14s %12s\n", "layout", "size", "lines/exp", "Mexp/s", "misses/exp");
+    for (std::uint32_t n : {1024u, 4096u})
+    {
+        std::vector<std::uint32_t> order = wavefront(n);
+        std::uint32_t *plane = static_cast<std::uint32_t *>(std::aligned_alloc(A_STAR_ALIGNMENT, std::size_t(n) * n * sizeof(std::uint32_t)));
+        std::fill_n(plane, std::size_t(n) * n, 1);
+
+        for (std::uint32_t l = 0; l < 2; l++)
+        {
+            // The window pattern repeats every tile and every cache line, a corner of the map is enough
+            double lines = window_lines(indices[l], 256);
+
+            bench_timer t;
+            misses.reset();
+            bench_keep(sweep(plane, indices[l], order, n));
+            std::uint64_t missed = misses.count();
+            double elapsed = t.seconds();
+
+            std::printf("%-10s %6u %12.2f %14.1f", layouts[l], n, lines, order.size() / elapsed / 1e6);
+            print_misses(misses, missed, double(order.size()));
+        }
+        std::free(plane);
+    }
+
+    const std::uint32_t queries = 20;
+    std::printf("\nA_star::run, %s build, random maps, %u random queries\n", layouts[A_STAR_TILED_GRID], queries);
+    std::printf("%-10s %6s %12s %14s %12s\n", "queue", "size", "expanded", "Mexp/s", "misses/exp");
+    for (std::uint32_t n : {1024u, 2048u, 4096u})
+    {
+        A_star planner(n, n);
+        build_map(planner, map_kind::random, n);
+
+        for (std::uint8_t queue : {A_STAR_QUEUE_HEAP, A_STAR_QUEUE_BUCKET})
+        {
+            planner.set_queue(queue);
+
+            std::mt19937 rng(n);
+            std::uint64_t expanded = 0, missed = 0;
+            double elapsed = 0;
+            for (std::uint32_t q = 0; q < queries; q++)
+            {
+                std::uint32_t sx = rng() % n, sy = rng() % n, tx = rng() % n, ty = rng() % n;
+                bench_timer t;
+                misses.reset();
+                planner.run(sx, sy, tx, ty);
+                missed += misses.count();
+                elapsed += t.seconds();
+                expanded += planner.expanded();
+            }
+
+            std::printf("%-10s %6u %12llu %14.2f", queue == A_STAR_QUEUE_HEAP ? "heap" : "bucket", n,
+                        static_cast<unsigned long long>(expanded), expanded / elapsed / 1e6);
+            print_misses(misses, missed, double(expanded));
+        }
+    }
+
+    return 0;
+}
@@ -1,8 +1,14 @@
 #include "pathfinder/a_star.hh"
 
+#include <cstdio>
+
 int main() {
     A_star pathfinder = A_star(100, 100);
-    pathfinder.run(5,10, 40, 56);
+
+    A_star::point path[256];
+    std::uint32_t length = pathfinder.run(5, 10, 40, 56, path, 256);
+
+    printf("path of %u points\n", length);
 
     return 0;
-}
\ No newline at end of file
+}
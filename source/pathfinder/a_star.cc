@@ -1,13 +1,15 @@
 #include "a_star.hh"
 #include "ioutils.hh"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
-#include <cmath>
+#include <thread>
 
-std::uint32_t _distance(std::uint32_t x1, std::uint32_t y1, std::uint32_t x2, std::uint32_t y2)
+std::uint32_t A_star::_distance(std::uint32_t x1, std::uint32_t y1, std::uint32_t x2, std::uint32_t y2)
 {
-    return std::sqrt(std::pow(x2 - x1, 2) + std::pow(y2 - y1, 2));
+    return heuristic_chebyshev::distance(heuristic_delta(x1, x2), heuristic_delta(y1, y2));
 }
 
 A_star::A_star(std::uint32_t xs, std::uint32_t ys)
@@ -17,143 +19,615 @@ A_star::A_star(std::uint32_t xs, std::uint32_t ys)
     this->_loadmap();
 }
 
+A_star::A_star(const char *path)
+{
+    this->_loadfile(path);
+}
+
+A_star::A_star(const A_star *shared)
+{
+    // Everything derived from the map is borrowed, read only, from the planner
+    this->map = shared->map;
+    this->tc = shared->tc;
+    this->xs = shared->xs;
+    this->ys = shared->ys;
+    this->stride = shared->stride;
+    this->mo = false;
+    this->_loadsearch();
+}
+
 A_star::~A_star()
 {
     this->_freemap();
 }
 
-void A_star::toggletile(std::uint32_t px, std::uint32_t py, bool tile_state)
+bool A_star::set_queue(std::uint8_t queue)
+{
+    if (queue != A_STAR_QUEUE_HEAP && queue != A_STAR_QUEUE_BUCKET)
+    {
+        cout_err("set_queue", "unknown open list backend");
+        return false;
+    }
+
+    if (queue == A_STAR_QUEUE_BUCKET && this->bh == nullptr)
+    {
+        if (!_check_map())
+            return false;
+
+        std::size_t cells = _cells();
+        this->bn = static_cast<a_star_index *>(mem.alloc(cells * sizeof(a_star_index)));
+        this->bp = static_cast<a_star_index *>(mem.alloc(cells * sizeof(a_star_index)));
+        this->bh = static_cast<a_star_index *>(mem.alloc(A_STAR_BUCKETS * sizeof(a_star_index)));
+        this->bb = static_cast<std::uint64_t *>(mem.alloc(A_STAR_BUCKETS / 64 * sizeof(std::uint64_t)));
+
+        if (this->bn == nullptr || this->bp == nullptr || this->bh == nullptr || this->bb == nullptr)
+        {
+            cout_err("set_queue", "could not allocate the bucket queue");
+            this->bh = nullptr;
+            return false;
+        }
+
+        std::fill_n(this->bh, A_STAR_BUCKETS, A_STAR_ERROR_INDEX);
+        std::fill_n(this->bb, A_STAR_BUCKETS / 64, 0);
+    }
+
+    this->qk = queue;
+    return true;
+}
+
+bool A_star::set_threads(std::uint32_t threads)
+{
+    if (!_check_map() || !this->mo)
+        return false;
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    this->tp.reset();
+    this->wk.clear();
+    for (std::uint32_t i = 1; i < threads; i++)
+    {
+        this->wk.emplace_back(new A_star(this));
+        if (this->wk.back()->map == nullptr)
+        {
+            cout_err("set_threads", "could not allocate a search context");
+            this->wk.clear();
+            return false;
+        }
+    }
+
+    this->tp.reset(new work_pool(threads));
+    // The component labels are built on these threads from now on
+    this->cp.reset();
+    return true;
+}
+
+// Argument of A_star::_batch
+struct batch_args
+{
+    A_star *planner;
+    const A_star::query *queries;
+    A_star::result *results;
+};
+
+void A_star::_batch(void *arg, std::uint32_t worker, std::uint32_t index)
+{
+    batch_args *batch = static_cast<batch_args *>(arg);
+    const query &q = batch->queries[index];
+    result &r = batch->results[index];
+
+    A_star *context = worker == 0 ? batch->planner : batch->planner->wk[worker - 1].get();
+
+    // Contexts have no labels of their own, they read the planner's
+    if (worker != 0 && context->_in_bounds(q.sx, q.sy) && context->_in_bounds(q.tx, q.ty) &&
+        !batch->planner->_reachable(context->_index(q.sx, q.sy), context->_index(q.tx, q.ty)))
+    {
+        r.length = 0;
+        r.expanded = 0;
+        return;
+    }
+
+    r.length = context->run(q.sx, q.sy, q.tx, q.ty, q.path, q.capacity);
+    r.expanded = context->ne;
+}
+
+void A_star::run_batch(const query *queries, result *results, std::uint32_t count)
 {
     if (!_check_map())
         return;
-    if (!_check_coords(px, py))
+
+    if (this->tp == nullptr && !set_threads(0))
         return;
 
-    this->map[px][py] = tile_state;
+    // Contexts follow the settings of the planner, jump tables included
+    for (std::unique_ptr<A_star> &context : this->wk)
+    {
+        if (context->qk != this->qk)
+            context->set_queue(this->qk);
+        context->xk = this->xk;
+        context->ek = this->ek;
+        context->sk = this->sk;
+        context->sf = this->sf;
+        context->jt = this->jt;
+        context->tc = this->tc;
+    }
+
+    // Workers read the labels, they must be up to date before the batch starts
+    if (this->cs)
+        this->cs = !_cc_build();
+
+    // Worker 0 searches with this planner, unidirectional like the contexts whatever set_bidirectional chose
+    std::uint8_t mode = this->dm;
+    this->dm = A_STAR_BIDIR_OFF;
+    batch_args batch = {this, queries, results};
+    this->tp->run(count, &A_star::_batch, &batch);
+    this->dm = mode;
 }
 
-std::uint32_t A_star::get_open_list(std::uint32_t px, std::uint32_t py)
+bool A_star::set_expansion(std::uint8_t expansion)
 {
-    if (!_check_coords(px, py))
-        return this->pl;
+    if (expansion != A_STAR_EXPAND_ALL && expansion != A_STAR_EXPAND_JPS && expansion != A_STAR_EXPAND_JPS_PLUS)
+    {
+        cout_err("set_expansion", "unknown expansion strategy");
+        return false;
+    }
 
-    std::uint32_t i;
-    for (i = 0; i < this->pl; i++)
+    if (expansion == A_STAR_EXPAND_JPS_PLUS && this->jt == nullptr)
     {
-        if (this->px[i] == px && this->py[i] == py)
-            break;
+        if (!_check_map() || !_jps_build())
+            return false;
+    }
+
+    if (expansion != A_STAR_EXPAND_ALL && this->ek != A_STAR_HEURISTIC_CHEBYSHEV)
+    {
+        cout_err("set_expansion", "jump point search needs the Chebyshev heuristic");
+        return false;
     }
-    return i;
+
+    this->xk = expansion;
+    return true;
 }
 
-std::uint32_t A_star::get_closed_list(std::uint32_t px, std::uint32_t py)
+bool A_star::set_heuristic(std::uint8_t heuristic)
 {
-    if (!_check_coords(px, py))
-        return this->pl;
+    if (heuristic != A_STAR_HEURISTIC_CHEBYSHEV && heuristic != A_STAR_HEURISTIC_MANHATTAN &&
+        heuristic != A_STAR_HEURISTIC_OCTILE && heuristic != A_STAR_HEURISTIC_EUCLIDEAN)
+    {
+        cout_err("set_heuristic", "unknown heuristic policy");
+        return false;
+    }
 
-    std::uint32_t i;
-    for (i = 0; i < this->plc; i++)
+    // Jump points assume every move costs the same
+    if (heuristic != A_STAR_HEURISTIC_CHEBYSHEV && this->xk != A_STAR_EXPAND_ALL)
     {
-        if (this->pxc[i] == px && this->pyc[i] == py)
-            break;
+        cout_err("set_heuristic", "jump point search needs the Chebyshev heuristic");
+        return false;
     }
-    return i;
+
+    this->ek = heuristic;
+    return true;
 }
 
-bool A_star::in_open_list(std::uint32_t px, std::uint32_t py)
+void A_star::toggletile(std::uint32_t px, std::uint32_t py, bool tile_state)
 {
+    if (!_check_map())
+        return;
     if (!_check_coords(px, py))
+        return;
+
+    a_star_index pi = _index(px, py);
+    if (_isblocked(pi) != tile_state)
+        return;
+
+#if A_STAR_PACKED_GRID
+    this->map[pi >> 6] ^= std::uint64_t(1) << (pi & 63);
+#else
+    this->map[pi] = (this->map[pi] & A_STAR_STATE_MASK_NEGATE) | static_cast<std::uint32_t>(tile_state);
+#endif
+    _changed(px, py);
+}
+
+bool A_star::blocked(std::uint32_t px, std::uint32_t py)
+{
+    if (this->map == nullptr || !_in_bounds(px, py))
+        return true;
+
+    return _isblocked(_index(px, py));
+}
+
+bool A_star::set_cost(std::uint32_t px, std::uint32_t py, std::uint8_t cost)
+{
+    if (!_check_map() || !_check_coords(px, py))
         return false;
-    for (std::uint32_t i = 0; i < this->pl; i++)
+
+    if (cost == 0)
     {
-        if (this->px[i] == px && this->py[i] == py)
+        cout_err("set_cost", "terrain costs start at 1");
+        return false;
+    }
+
+    if (this->tc == nullptr)
+    {
+        if (cost == 1)
             return true;
+
+        // Rows are a multiple of 16 cells, padded here to a whole alignment unit
+        std::size_t cells = _cells();
+        std::size_t bytes = (cells + A_STAR_ALIGNMENT - 1) / A_STAR_ALIGNMENT * A_STAR_ALIGNMENT;
+        this->tc = static_cast<std::uint8_t *>(std::aligned_alloc(A_STAR_ALIGNMENT, std::max<std::size_t>(bytes, A_STAR_ALIGNMENT)));
+        if (this->tc == nullptr)
+        {
+            cout_err("set_cost", "could not allocate the terrain costs");
+            return false;
+        }
+        std::fill_n(this->tc, cells, 1);
+
+        if (this->dw != nullptr)
+            this->dw->tc = this->tc;
     }
-    return false;
+
+    this->tc[_index(px, py)] = cost;
+    return true;
+}
+
+std::uint8_t A_star::cost(std::uint32_t px, std::uint32_t py)
+{
+    if (this->map == nullptr || !_in_bounds(px, py))
+        return 0;
+
+    return this->tc != nullptr ? this->tc[_index(px, py)] : 1;
+}
+
+a_star_index A_star::get_open_list(std::uint32_t px, std::uint32_t py)
+{
+    if (!_check_coords(px, py))
+        return this->pl;
+
+    a_star_index pi = _index(px, py);
+    if (this->sg[pi] != this->gen || this->hp[pi] == A_STAR_ERROR_INDEX)
+        return this->pl;
+    return this->hp[pi];
+}
+
+bool A_star::in_open_list(std::uint32_t px, std::uint32_t py)
+{
+    if (!_check_coords(px, py))
+        return false;
+    a_star_index pi = _index(px, py);
+    return this->sg[pi] == this->gen && this->hp[pi] != A_STAR_ERROR_INDEX;
 }
 
 bool A_star::in_closed_list(std::uint32_t px, std::uint32_t py)
 {
     if (!_check_coords(px, py))
         return false;
-    for (std::uint32_t i = 0; i < this->plc; i++)
-    {
-        if (this->pxc[i] == px && this->pyc[i] == py)
-            return true;
-    }
-    return false;
+    return _isclosed(_index(px, py));
 }
 
-bool A_star::check_node(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty, std::uint16_t gcost)
+template <typename H>
+bool A_star::check_node(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty, a_star_cost gcost, std::uint8_t dir,
+                        a_star_cost step)
 {
-    std::uint16_t new_gcost = gcost + 1;
-    std::uint16_t new_fcost = _distance(sx, sy, tx, ty) + new_gcost;
+    // Neighbors of border cells wrap around to huge unsigned values
+    if (!_in_bounds(sx, sy))
+        return false;
 
-    bool right_open = in_open_list(sx, sy);
-    bool right_closed = in_closed_list(sx, sy);
-    bool is_right_better = _getfcost(sx, sy) < new_fcost;
+    a_star_index pi = _index(sx, sy);
+
+    if (_isblocked(pi) || std::uint64_t(gcost) + step > A_STAR_GCOST_MAX)
+        return false;
+
+    _touch(pi);
+
+    if (_isclosed(pi))
+        return false;
+
+    a_star_cost new_gcost = gcost + step;
+    a_star_cost new_fcost = _fcost<H>(sx, sy, tx, ty, new_gcost);
+    a_star_index slot = this->hp[pi];
+
+    if (slot != A_STAR_ERROR_INDEX)
+    {
+        // Already open: decrease-key in place instead of pushing it twice
+        if (_getfcost(pi) > new_fcost)
+        {
+            _setgcost(pi, new_gcost);
+            _setfcost(pi, new_fcost);
+            this->pd[pi] = dir;
+            _decrease(pi);
+        }
+        return false;
+    }
 
-    return !(right_open && is_right_better) && !(right_closed && is_right_better);
+    _setgcost(pi, new_gcost);
+    _setfcost(pi, new_fcost);
+    this->pd[pi] = dir;
+    return true;
 }
 
-void A_star::run(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty)
+bool A_star::run(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty)
 {
     cout_debug("run", "starting path calculation");
+    A_STAR_STAT(this->st = stats());
 
     if (!_check_map())
-        return;
+        return false;
 
     if (!_check_coords(sx, sy) || !_check_coords(tx, ty))
-        return;
+        return false;
 
-    if (sx == tx && sy == ty)
-        return;
+#if A_STAR_STATS
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+#endif
+    bool found = _dispatch(sx, sy, tx, ty);
+#if A_STAR_STATS
+    this->st.search_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+#endif
+    this->st.expanded = this->ne;
+    return found;
+}
 
-    cout_debug("run", "Loading a new point array");
-    _loadpnt(tx - sx, ty - sy);
+bool A_star::_dispatch(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty)
+{
+    this->dc = A_STAR_ERROR_INDEX;
 
-    _add(sx, sy);
-    this->map[sx][sy] = A_STAR_NODE_STARTER;
+    // Labels toggletile left out of date are rebuilt before they are read
+    if (this->cs)
+        this->cs = !_cc_build();
+
+    // Cells in different components are never joined, whatever the search
+    if (!_reachable(_index(sx, sy), _index(tx, ty)))
+    {
+        this->ne = 0;
+        this->rs = A_STAR_ERROR_INDEX;
+        return false;
+    }
+
+    // Terrain costs make moves asymmetric, the backward frontier would price them wrong
+    if (this->dm != A_STAR_BIDIR_OFF && this->tc == nullptr)
+        return _run_bidir(sx, sy, tx, ty);
+
+#if A_STAR_COST_BITS > 16
+    // A jump raises f_cost by up to twice its length, jumps across such a map could wrap the bucket ring around
+    if (this->qk == A_STAR_QUEUE_BUCKET && this->xk != A_STAR_EXPAND_ALL && this->tc == nullptr &&
+        std::max(this->xs, this->ys) >= A_STAR_BUCKETS / 4)
+    {
+        this->qk = A_STAR_QUEUE_HEAP;
+        bool found = _search<heuristic_chebyshev>(sx, sy, tx, ty);
+        this->qk = A_STAR_QUEUE_BUCKET;
+        return found;
+    }
+#endif
+
+    switch (this->ek)
+    {
+    case A_STAR_HEURISTIC_MANHATTAN:
+        return _search<heuristic_manhattan>(sx, sy, tx, ty);
+    case A_STAR_HEURISTIC_OCTILE:
+        return _search<heuristic_octile>(sx, sy, tx, ty);
+    case A_STAR_HEURISTIC_EUCLIDEAN:
+        return _search<heuristic_euclidean>(sx, sy, tx, ty);
+    default:
+        return _search<heuristic_chebyshev>(sx, sy, tx, ty);
+    }
+}
+
+template <typename H>
+bool A_star::_search(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty)
+{
+    _begin(sx, sy, H::straight, H::diagonal);
 
     while (this->pl > 0)
     {
         cout_debug("run", "evaluating...");
-        std::uint32_t x = this->px[0];
-        std::uint32_t y = this->px[0];
-        std::uint32_t el = _remove(0);
-        std::uint16_t fcost = _getfcost(x, y);
-        std::uint16_t gcost = _getgcost(x, y);
+        a_star_index pi = _pop();
+        std::uint32_t x = _column(pi);
+        std::uint32_t y = _row(pi);
+
+        if (x == tx && y == ty)
+            return true;
 
-        if (check_node(x + 1, y, tx, ty, gcost))
-            _add(x + 1, y);
+        a_star_cost gcost = _getgcost(pi);
+        this->ne++;
 
-        if (check_node(x - 1, y, tx, ty, gcost))
-            _add(x - 1, y);
+        // set_heuristic keeps jump point search to the Chebyshev policy, jumps assume uniform costs
+        if (this->xk != A_STAR_EXPAND_ALL && this->tc == nullptr)
+            _expand_jps(x, y, tx, ty, gcost);
+        else
+            _expand<H>(x, y, tx, ty, gcost);
+        _setclosed(pi);
+    }
+
+    return false;
+}
+
+void A_star::_begin(std::uint32_t sx, std::uint32_t sy, std::uint16_t straight, std::uint16_t diagonal)
+{
+    _loadpnt();
 
-        if (check_node(x, y + 1, tx, ty, gcost))
-            _add(x, y + 1);
+    this->ne = 0;
+    this->es = straight;
+    this->ed = diagonal;
+    _newgen();
 
-        if (check_node(x, y - 1, tx, ty, gcost))
-            _add(x, y - 1);
+    a_star_index si = _index(sx, sy);
+    _touch(si);
+    this->sw[si] = A_STAR_NODE_STARTER;
+    this->rs = si;
+    _add(sx, sy);
+}
 
-        if (check_node(x + 1, y + 1, tx, ty, gcost))
-            _add(x + 1, y + 1);
+template <typename H>
+void A_star::_expand(std::uint32_t x, std::uint32_t y, std::uint32_t tx, std::uint32_t ty, a_star_cost gcost)
+{
+    if (this->tc != nullptr)
+    {
+        _expand_weighted<H>(x, y, tx, ty, gcost);
+        return;
+    }
 
-        if (check_node(x + 1, y - 1, tx, ty, gcost))
-            _add(x + 1, y - 1);
+    // The kernels take the step for granted, so cells this deep go through check_node and its overflow test
+    if (this->sf != nullptr && gcost <= A_STAR_GCOST_MAX - H::diagonal)
+    {
+        // The kernel already ruled out walls, closed cells and paths that are no shorter
+        std::uint32_t mask = this->sf(this, _index(x, y), x, y, gcost, H::straight, H::diagonal);
+        while (mask != 0)
+        {
+            std::uint8_t dir = static_cast<std::uint8_t>(__builtin_ctz(mask));
+            mask &= mask - 1;
 
-        if (check_node(x - 1, y - 1, tx, ty, gcost))
-            _add(x - 1, y - 1);
+            std::uint32_t nx = x + dir_x[dir], ny = y + dir_y[dir];
+            a_star_index pi = _index(nx, ny);
+            a_star_cost new_gcost = gcost + (dir < A_STAR_DIR_SE ? H::straight : H::diagonal);
 
-        if (check_node(x - 1, y + 1, tx, ty, gcost))
-            _add(x - 1, y + 1);
+            _touch(pi);
+            _setgcost(pi, new_gcost);
+            _setfcost(pi, _fcost<H>(nx, ny, tx, ty, new_gcost));
+            this->pd[pi] = dir;
 
-        _add_cl(x, y);
+            if (this->hp[pi] != A_STAR_ERROR_INDEX)
+                _decrease(pi);
+            else
+                _add(nx, ny);
+        }
+        return;
     }
 
-    _freepnt();
+    if (check_node<H>(x + 1, y, tx, ty, gcost, A_STAR_DIR_E, H::straight))
+        _add(x + 1, y);
+
+    if (check_node<H>(x - 1, y, tx, ty, gcost, A_STAR_DIR_W, H::straight))
+        _add(x - 1, y);
+
+    if (check_node<H>(x, y + 1, tx, ty, gcost, A_STAR_DIR_S, H::straight))
+        _add(x, y + 1);
+
+    if (check_node<H>(x, y - 1, tx, ty, gcost, A_STAR_DIR_N, H::straight))
+        _add(x, y - 1);
+
+    if (check_node<H>(x + 1, y + 1, tx, ty, gcost, A_STAR_DIR_SE, H::diagonal))
+        _add(x + 1, y + 1);
+
+    if (check_node<H>(x + 1, y - 1, tx, ty, gcost, A_STAR_DIR_NE, H::diagonal))
+        _add(x + 1, y - 1);
+
+    if (check_node<H>(x - 1, y - 1, tx, ty, gcost, A_STAR_DIR_NW, H::diagonal))
+        _add(x - 1, y - 1);
+
+    if (check_node<H>(x - 1, y + 1, tx, ty, gcost, A_STAR_DIR_SW, H::diagonal))
+        _add(x - 1, y + 1);
+}
+
+template <typename H>
+void A_star::_expand_weighted(std::uint32_t x, std::uint32_t y, std::uint32_t tx, std::uint32_t ty, a_star_cost gcost)
+{
+    for (std::uint8_t dir = 0; dir < 8; dir++)
+    {
+        std::uint32_t nx = x + dir_x[dir], ny = y + dir_y[dir];
+        if (!_in_bounds(nx, ny))
+            continue;
+
+        // At most 14 * 255, check_node drops the move if the g_cost would overflow
+        a_star_cost step = static_cast<a_star_cost>((dir < A_STAR_DIR_SE ? H::straight : H::diagonal) * this->tc[_index(nx, ny)]);
+        if (check_node<H>(nx, ny, tx, ty, gcost, dir, step))
+            _add(nx, ny);
+    }
+}
+
+// Other files only search with the Chebyshev policy
+template bool A_star::check_node<heuristic_chebyshev>(std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t, a_star_cost,
+                                                     std::uint8_t, a_star_cost);
+template void A_star::_expand<heuristic_chebyshev>(std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t, a_star_cost);
+
+std::uint32_t A_star::run(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty,
+                          point *path, std::uint32_t capacity)
+{
+    if (!run(sx, sy, tx, ty))
+        return 0;
+
+#if A_STAR_STATS
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::uint32_t length = reconstruct(tx, ty, path, capacity);
+    this->st.path_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return length;
+#else
+    return reconstruct(tx, ty, path, capacity);
+#endif
+}
+
+std::uint32_t A_star::reconstruct(std::uint32_t tx, std::uint32_t ty, point *path, std::uint32_t capacity)
+{
+    if (!_check_map() || !_check_coords(tx, ty))
+        return 0;
+
+    if (this->dc != A_STAR_ERROR_INDEX && _index(tx, ty) == this->dw->rs)
+        return _reconstruct_bidir(path, capacity);
+    return _reconstruct(tx, ty, path, capacity);
+}
+
+std::uint32_t A_star::_reconstruct(std::uint32_t tx, std::uint32_t ty, point *path, std::uint32_t capacity)
+{
+    a_star_index ti = _index(tx, ty);
+    if (this->rs == A_STAR_ERROR_INDEX || this->sg[ti] != this->gen)
+        return 0;
+
+    /**
+     * A parent link is the move that reached the cell, and the parent lies
+     * some steps back along it: one step for plain A*, a whole jump for JPS.
+     * Stepping back lowers the cost by the price of the move; the walk
+     * only takes a new link from an expanded cell whose own cost matches,
+     * which is the parent or a cell with an equally short path of its own.
+     * The first walk counts the points, the second fills the buffer from its
+     * end so it reads start to target.
+     */
+    std::uint32_t length = 1;
+    std::uint32_t x = tx, y = ty;
+    a_star_cost g = _getgcost(ti);
+    std::uint8_t dir = A_STAR_DIR_NONE;
+    for (a_star_index pi = ti; pi != this->rs; pi = _index(x, y))
+    {
+        if (dir == A_STAR_DIR_NONE || (_isclosed(pi) && _getgcost(pi) == g))
+            dir = this->pd[pi];
+
+        if (dir == A_STAR_DIR_NONE)
+            return 0;
+
+        a_star_cost step = _step(pi, dir);
+        if (g < step)
+            return 0;
+
+        g -= step;
+        x -= dir_x[dir];
+        y -= dir_y[dir];
+        length++;
+    }
+
+    if (path == nullptr || length > capacity)
+        return length;
+
+    x = tx;
+    y = ty;
+    g = _getgcost(ti);
+    dir = A_STAR_DIR_NONE;
+    for (std::uint32_t i = length; i-- > 0;)
+    {
+        path[i] = {x, y};
+        if (i == 0)
+            break;
+
+        a_star_index pi = _index(x, y);
+        if (dir == A_STAR_DIR_NONE || (_isclosed(pi) && _getgcost(pi) == g))
+            dir = this->pd[pi];
+
+        g -= _step(pi, dir);
+        x -= dir_x[dir];
+        y -= dir_y[dir];
+    }
+
+    return length;
 }
 
+
 bool A_star::_check_map()
 {
     cout_debug("_check_map", "trying to check map");
@@ -170,8 +644,7 @@ bool A_star::_check_map()
 
 bool A_star::_check_coords(std::uint32_t px, std::uint32_t py)
 {
-
-    if (px * py >= this->xs * this->ys)
+    if (!_in_bounds(px, py))
     {
         cout_err("_getfcost", "indices out of bounds");
         return false;
@@ -180,258 +653,303 @@ bool A_star::_check_coords(std::uint32_t px, std::uint32_t py)
     return true;
 }
 
-void A_star::_loadmap()
+bool A_star::_layout(std::uint32_t xs, std::uint32_t ys, std::uint32_t &stride)
 {
-    map = static_cast<std::uint32_t **>(std::calloc(this->xs, sizeof(std::uint32_t *)));
+    constexpr std::uint64_t row_align = A_STAR_ALIGNMENT / sizeof(std::uint32_t);
+
+    std::uint64_t wide = (std::uint64_t(xs) + row_align - 1) / row_align * row_align;
+#if A_STAR_TILED_GRID
+    std::uint64_t rows = (std::uint64_t(ys) + A_STAR_TILE - 1) & ~std::uint64_t(A_STAR_TILE - 1);
+#else
+    std::uint64_t rows = ys;
+#endif
+    std::uint64_t cells = wide * rows;
+    stride = static_cast<std::uint32_t>(wide);
+
+    // The largest per-cell buffers are the JPS+ tables, 8 entries a cell
+    return wide <= 0xFFFFFFFF && (rows == 0 || cells / rows == wide) && cells <= A_STAR_ERROR_INDEX &&
+           cells <= SIZE_MAX / (8 * sizeof(std::int32_t));
+}
 
-    for (int xi = 0; xi < this->xs; xi++)
+void A_star::_loadmap()
+{
+    if (!_layout(this->xs, this->ys, this->stride))
     {
-        map[xi] = static_cast<std::uint32_t *>(std::calloc(this->ys, sizeof(std::uint32_t)));
+        cout_err("_loadmap", "the map has too many cells for A_STAR_INDEX_BITS");
+        this->stride = 0;
+        return;
+    }
 
-        for (int yi = 0; yi < this->ys; yi++)
-        {
-            map[xi][yi] = A_STAR_NODE_ENABLED;
-        }
+    std::size_t cells = _cells();
+#if A_STAR_PACKED_GRID
+    // Every cell starts free, all bits clear: zeroed pages are only backed by memory once written
+    map = static_cast<std::uint64_t *>(std::calloc(std::max<std::size_t>((cells + 63) / 64, 1), sizeof(std::uint64_t)));
+#else
+    // aligned_alloc needs the size to be a multiple of the alignment, rows already are
+    constexpr std::uint32_t row_align = A_STAR_ALIGNMENT / sizeof(std::uint32_t);
+    map = static_cast<std::uint32_t *>(std::aligned_alloc(A_STAR_ALIGNMENT, std::max<std::size_t>(cells, row_align) * sizeof(std::uint32_t)));
+#endif
+
+    if (map == nullptr)
+    {
+        cout_err("_loadmap", "could not allocate the map");
+        return;
     }
+
+#if !A_STAR_PACKED_GRID
+    std::fill_n(map, cells, A_STAR_NODE_ENABLED);
+#endif
+    mo = true;
+
+    _loadsearch();
 }
 
-void A_star::_freemap()
+void A_star::_loadsearch()
 {
-    for (int xi = 0; xi < this->xs; xi++)
+    std::size_t cells = _cells();
+
+    // On open maps the frontier is bounded by the perimeter of the searched area
+    cls = (cells + 63) / 64;
+    ps = static_cast<a_star_index>(std::min<std::size_t>(std::max<std::size_t>(cells, 1),
+                                                          std::max<std::size_t>(A_STAR_OPEN_LIST_MIN, 2 * (std::size_t(this->xs) + this->ys))));
+
+    // One block for everything, each buffer padded to the alignment
+    std::size_t bytes = (cells * sizeof(std::uint32_t) + A_STAR_ALIGNMENT) +
+                        (cells * sizeof(a_star_word) + A_STAR_ALIGNMENT) +
+                        (cells * sizeof(std::uint8_t) + A_STAR_ALIGNMENT) +
+                        (cls * sizeof(std::uint64_t) + A_STAR_ALIGNMENT) +
+                        (cells * sizeof(a_star_index) + A_STAR_ALIGNMENT) +
+                        (ps * sizeof(a_star_index) + A_STAR_ALIGNMENT);
+    mem.reserve(bytes);
+
+    sg = static_cast<std::uint32_t *>(mem.alloc(cells * sizeof(std::uint32_t)));
+    sw = static_cast<a_star_word *>(mem.alloc(cells * sizeof(a_star_word)));
+    hp = static_cast<a_star_index *>(mem.alloc(cells * sizeof(a_star_index)));
+    pd = static_cast<std::uint8_t *>(mem.alloc(cells * sizeof(std::uint8_t)));
+    cl = static_cast<std::uint64_t *>(mem.alloc(cls * sizeof(std::uint64_t)));
+    pc = static_cast<a_star_index *>(mem.alloc(ps * sizeof(a_star_index)));
+
+    if (sg == nullptr || sw == nullptr || hp == nullptr || pd == nullptr || cl == nullptr || pc == nullptr)
     {
-        if (map[xi] != nullptr)
-            free(map[xi]);
+        cout_err("_loadsearch", "could not allocate the search state");
+        _freemap();
+        return;
     }
 
-    free(map);
+    // Search state is only read after _touch stamps it, and the arena hands the stamps out zeroed
+    gen = 0;
+
+    set_simd(A_STAR_SIMD_AUTO);
 }
 
-void A_star::_loadpnt(std::uint32_t xs, std::uint32_t ys)
+void A_star::_freemap()
 {
-    this->px = static_cast<std::uint32_t *>(std::calloc(xs * ys, sizeof(std::uint32_t)));
-    this->py = static_cast<std::uint32_t *>(std::calloc(xs * ys, sizeof(std::uint32_t)));
-    this->pxc = static_cast<std::uint32_t *>(std::calloc(xs * ys, sizeof(std::uint32_t)));
-    this->pyc = static_cast<std::uint32_t *>(std::calloc(xs * ys, sizeof(std::uint32_t)));
-    this->ps = xs * ys;
-    this->pl = 0;
-    this->plc = 0;
+    // Search buffers belong to A_star::mem and go away with it
+    if (mo)
+    {
+        if (mf != nullptr)
+            _closefile();
+        else
+            std::free(map);
+        std::free(tc);
+    }
+    map = nullptr;
+    tc = nullptr;
+    sg = nullptr;
+    sw = nullptr;
+    hp = nullptr;
+    pd = nullptr;
+    cl = nullptr;
+    pc = nullptr;
+    ps = 0;
+    jt = nullptr;
+    ce = false;
+    cs = false;
+    cc = nullptr;
+    lg = nullptr;
+    lr = nullptr;
+    lt = A_STAR_ERROR_INDEX;
 }
 
-void A_star::_freepnt()
+void A_star::_changed(std::uint32_t px, std::uint32_t py)
 {
-    if (this->px != nullptr)
-        free(this->px);
-    if (this->py != nullptr)
-        free(this->py);
-    this->ps = 0;
+    if (this->jt != nullptr)
+        _jps_update(px, py);
+
+    if (this->ce)
+        _cc_update(px, py);
+
+    // Repaired by the next incremental replan
+    if (this->lg != nullptr)
+        this->lc.push_back(_index(px, py));
+
+    // Entrances look one cell across borders and corners, so nearby clusters may change too
+    if (this->hc != 0)
+    {
+        for (std::uint32_t y = py > 0 ? py - 1 : 0; y <= py + 1 && y < this->ys; y++)
+            for (std::uint32_t x = px > 0 ? px - 1 : 0; x <= px + 1 && x < this->xs; x++)
+            {
+                std::uint32_t k = _hpa_of(x, y);
+                if (!this->hk[k].dirty)
+                {
+                    this->hk[k].dirty = true;
+                    this->hq.push_back(k);
+                }
+            }
+    }
 }
 
-bool A_star::_isblocked(std::uint32_t px, std::uint32_t py)
+void A_star::_loadpnt()
 {
-    if (!_check_coords(px, py))
-        return false;
-
-    return (this->map[px][py] & A_STAR_STATE_MASK) == 1;
+    if (this->qk == A_STAR_QUEUE_BUCKET)
+        _bucket_clear();
+    this->pl = 0;
 }
 
-std::uint16_t A_star::_getfcost(std::uint32_t px, std::uint32_t py)
+bool A_star::_growpnt()
 {
-    if (!_check_coords(px, py))
-        return A_STAR_ERROR_16;
+    std::size_t cells = _cells();
+    if (this->ps >= cells)
+        return false;
 
-    std::uint32_t p = this->map[px][py];
+    a_star_index size = static_cast<a_star_index>(std::min<std::size_t>(2 * std::size_t(this->ps), cells));
+    a_star_index *list = static_cast<a_star_index *>(mem.alloc(size * sizeof(a_star_index)));
+    if (list == nullptr)
+        return false;
 
-    return static_cast<std::uint16_t>((p & A_STAR_FCOST_MASK) >> 16);
+    std::copy_n(this->pc, this->pl, list);
+    this->pc = list;
+    this->ps = size;
+    return true;
 }
 
-std::uint16_t A_star::_getgcost(std::uint32_t px, std::uint32_t py)
+bool A_star::_isblocked(a_star_index pi) const
 {
-    if (!_check_coords(px, py))
-        return A_STAR_ERROR_16;
+#if A_STAR_PACKED_GRID
+    return (this->map[pi >> 6] >> (pi & 63)) & 1;
+#else
+    return (this->map[pi] & A_STAR_STATE_MASK) == 0;
+#endif
+}
 
-    std::uint32_t p = this->map[px][py];
+void A_star::_newgen()
+{
+    this->gen++;
 
-    return static_cast<std::uint16_t>((p & A_STAR_GCOST_MASK) >> 1);
+    // Once every 2^32 searches the stamps wrap around and must really be cleared
+    if (this->gen == 0)
+    {
+        std::fill_n(this->sg, _cells(), 0);
+        this->gen = 1;
+    }
 }
 
-void A_star::_setfcost(std::uint32_t px, std::uint32_t py, std::uint16_t f_cost)
+void A_star::_touch(a_star_index pi)
 {
-    if (!_check_coords(px, py))
+    if (this->sg[pi] == this->gen)
         return;
 
-    std::uint32_t p = this->map[px][py];
-
-    p = (p & A_STAR_FCOST_MASK_NEGATE) | static_cast<std::uint32_t>(f_cost << 16);
-
-    this->map[px][py] = p;
+    this->sg[pi] = this->gen;
+    this->sw[pi] = A_STAR_NODE_UNSEEN;
+    this->hp[pi] = A_STAR_ERROR_INDEX;
+    this->pd[pi] = A_STAR_DIR_NONE;
+    this->cl[pi >> 6] &= ~(std::uint64_t(1) << (pi & 63));
 }
 
-void A_star::_setgcost(std::uint32_t px, std::uint32_t py, std::uint16_t g_cost)
+a_star_cost A_star::_getfcost(a_star_index pi)
 {
-    if (!_check_coords(px, py))
-        return;
+    a_star_word p = this->sw[pi];
 
-    std::uint32_t p = this->map[px][py];
+    return static_cast<a_star_cost>((p & A_STAR_FCOST_MASK) >> A_STAR_COST_BITS);
+}
 
-    p = (p & A_STAR_GCOST_MASK_NEGATE) | static_cast<std::uint32_t>(g_cost << 1);
+a_star_cost A_star::_getgcost(a_star_index pi)
+{
+    a_star_word p = this->sw[pi];
 
-    this->map[px][py] = p;
+    return static_cast<a_star_cost>((p & A_STAR_GCOST_MASK) >> 1);
 }
 
-/* START Min binary heap functions */
-
-void A_star::_exchange(std::uint32_t i0, std::uint32_t i1)
+void A_star::_setfcost(a_star_index pi, a_star_cost f_cost)
 {
-    std::uint32_t tempx, tempy;
-    tempx = this->px[i0];
-    tempy = this->py[i0];
+    a_star_word p = this->sw[pi];
 
-    this->px[i0] = this->px[i1];
-    this->py[i0] = this->py[i1];
+    p = (p & A_STAR_FCOST_MASK_NEGATE) | (static_cast<a_star_word>(f_cost) << A_STAR_COST_BITS);
 
-    this->px[i1] = tempx;
-    this->py[i1] = tempy;
+    this->sw[pi] = p;
 }
 
-void A_star::_swim_cl(std::uint32_t pi)
+void A_star::_setgcost(a_star_index pi, a_star_cost g_cost)
 {
-    if (pi >= this->plc)
-        return;
+    a_star_word p = this->sw[pi];
 
-    std::uint32_t x = this->pxc[pi];
-    std::uint32_t y = this->pyc[pi];
-    uint16_t cost = _getfcost(x, y);
+    p = (p & A_STAR_GCOST_MASK_NEGATE) | ((static_cast<a_star_word>(g_cost) << 1) & A_STAR_GCOST_MASK);
 
-    std::uint32_t parent = (pi - 1) / 2;
+    this->sw[pi] = p;
+}
 
-    while (parent > 0)
-    {
-        if (cost > _getfcost(this->pxc[parent], this->pyc[parent]))
-            break;
+/* START Min binary heap functions */
 
-        _exchange(pi, parent);
-        pi = parent;
-        parent = (pi - 1) / 2;
-    }
+void A_star::_exchange(a_star_index i0, a_star_index i1)
+{
+    a_star_index temp = this->pc[i0];
+
+    this->pc[i0] = this->pc[i1];
+    this->pc[i1] = temp;
+
+    this->hp[this->pc[i0]] = i0;
+    this->hp[this->pc[i1]] = i1;
 }
 
-void A_star::_swim(std::uint32_t pi)
+void A_star::_swim(a_star_index pi)
 {
     if (pi >= this->pl)
         return;
 
-    std::uint32_t x = this->px[pi];
-    std::uint32_t y = this->py[pi];
-    uint16_t cost = _getfcost(x, y);
-
-    std::uint32_t parent = (pi - 1) / 2;
+    a_star_cost cost = _getfcost(this->pc[pi]);
 
-    while (parent > 0)
+    while (pi > 0)
     {
-        if (cost > _getfcost(this->px[parent], this->py[parent]))
+        a_star_index parent = (pi - 1) / 2;
+
+        if (cost >= _getfcost(this->pc[parent]))
             break;
 
         _exchange(pi, parent);
         pi = parent;
-        parent = (pi - 1) / 2;
     }
 }
 
-void A_star::_sink_cl(std::uint32_t pi)
+void A_star::_sink(a_star_index pi)
 {
-    if (pi >= this->plc)
+    if (pi >= this->pl)
         return;
 
-    std::uint32_t x = this->pxc[pi];
-    std::uint32_t y = this->pyc[pi];
-    uint16_t cost = _getfcost(x, y);
+    a_star_cost cost = _getfcost(this->pc[pi]);
 
-    std::uint32_t left_child = 2 * pi + 1;
-    std::uint32_t right_child = 2 * pi + 2;
+    a_star_index left_child = 2 * pi + 1;
+    a_star_index right_child = 2 * pi + 2;
 
-    while (left_child < this->plc)
+    while (left_child < this->pl)
     {
-        if (right_child >= this->plc)
-        {
-            if (cost > _getfcost(this->pxc[left_child], this->pyc[left_child]))
-                _exchange(pi, left_child);
-            pi = left_child;
-            break;
-        }
+        a_star_index child = left_child;
+        a_star_cost child_cost = _getfcost(this->pc[left_child]);
 
-        uint16_t left_cost = _getfcost(this->pxc[left_child], this->pyc[left_child]);
-        uint16_t right_cost = _getfcost(this->pxc[right_child], this->pyc[right_child]);
-
-        if (left_cost < right_cost)
-        {
-            if (cost > left_cost)
-            {
-                _exchange(pi, left_child);
-                pi = left_child;
-            }
-            else
-                break;
-        }
-        else
+        if (right_child < this->pl)
         {
-            if (cost > right_cost)
+            a_star_cost right_cost = _getfcost(this->pc[right_child]);
+            if (right_cost < child_cost)
             {
-                _exchange(pi, right_child);
-                pi = right_child;
+                child = right_child;
+                child_cost = right_cost;
             }
-            else
-                break;
         }
-        left_child = 2 * pi + 1;
-        right_child = 2 * pi + 2;
-    }
-}
-
-void A_star::_sink(std::uint32_t pi)
-{
-    if (pi >= this->pl)
-        return;
 
-    std::uint32_t x = this->px[pi];
-    std::uint32_t y = this->py[pi];
-    uint16_t cost = _getfcost(x, y);
-
-    std::uint32_t left_child = 2 * pi + 1;
-    std::uint32_t right_child = 2 * pi + 2;
-
-    while (left_child < this->pl)
-    {
-        if (right_child >= this->pl)
-        {
-            if (cost > _getfcost(this->px[left_child], this->py[left_child]))
-                _exchange(pi, left_child);
-            pi = left_child;
+        if (cost <= child_cost)
             break;
-        }
 
-        uint16_t left_cost = _getfcost(this->px[left_child], this->py[left_child]);
-        uint16_t right_cost = _getfcost(this->px[right_child], this->py[right_child]);
-
-        if (left_cost < right_cost)
-        {
-            if (cost > left_cost)
-            {
-                _exchange(pi, left_child);
-                pi = left_child;
-            }
-            else
-                break;
-        }
-        else
-        {
-            if (cost > right_cost)
-            {
-                _exchange(pi, right_child);
-                pi = right_child;
-            }
-            else
-                break;
-        }
+        _exchange(pi, child);
+        pi = child;
         left_child = 2 * pi + 1;
         right_child = 2 * pi + 2;
     }
@@ -445,74 +963,172 @@ void A_star::_add(std::uint32_t x, std::uint32_t y)
         return;
     }
 
-    if (this->pl >= this->ps)
+    if (this->qk == A_STAR_QUEUE_BUCKET)
+    {
+        _bucket_add(_index(x, y));
+        this->pl++;
+        A_STAR_STAT(this->st.pushed++, this->st.peak_open = std::max(this->st.peak_open, this->pl));
+        return;
+    }
+
+    if (this->pl >= this->ps && !_growpnt())
     {
         cout_warn("_add", "could not add, list size too tiny");
         return;
     }
 
-    this->px[this->pl] = x;
-    this->py[this->pl] = y;
-    _swim(this->pl);
+    a_star_index pi = _index(x, y);
+    this->pc[this->pl] = pi;
+    this->hp[pi] = this->pl;
     this->pl++;
+    A_STAR_STAT(this->st.pushed++, this->st.peak_open = std::max(this->st.peak_open, this->pl));
+    _swim(this->pl - 1);
 }
 
-std::uint32_t A_star::_remove(std::uint32_t pi)
+a_star_index A_star::_remove(a_star_index pi)
 {
     if (this->pl <= 0)
     {
         cout_warn("_remove", "could not remove, empty list");
-        return A_STAR_ERROR_32;
+        return A_STAR_ERROR_INDEX;
     }
 
-    if (pi < 0 || pi > this->pl)
+    if (pi >= this->pl)
     {
         cout_warn("_remove", "could not remove, bad index");
-        return A_STAR_ERROR_32;
+        return A_STAR_ERROR_INDEX;
     }
 
-    _exchange(pi, this->pl);
     this->pl--;
+    _exchange(pi, this->pl);
+    this->hp[this->pc[this->pl]] = A_STAR_ERROR_INDEX;
 
     _sink(pi);
-    return _getfcost(this->px[this->pl], this->py[this->pl]);
+    return _getfcost(this->pc[this->pl]);
 }
 
-void A_star::_add_cl(std::uint32_t x, std::uint32_t y)
+/* END Min binary heap functions */
+
+/* START Open list functions */
+
+a_star_index A_star::_pop()
 {
-    if (this->plc >= this->ps)
+    A_STAR_STAT(this->st.popped++);
+    if (this->qk == A_STAR_QUEUE_BUCKET)
     {
-        cout_warn("_add", "could not add, list size too tiny");
-        return;
+        a_star_index pi = _bucket_pop();
+        if (pi != A_STAR_ERROR_INDEX)
+            this->pl--;
+        return pi;
     }
 
-    this->pxc[this->plc] = x;
-    this->pyc[this->plc] = y;
-    _swim_cl(this->plc);
-    this->plc++;
+    a_star_index pi = this->pc[0];
+    _remove(0);
+    return pi;
 }
 
-std::uint32_t A_star::_remove_cl(std::uint32_t pi)
+void A_star::_decrease(a_star_index pi)
 {
-    if (this->plc <= 0)
+    A_STAR_STAT(this->st.decreased++);
+    if (this->qk == A_STAR_QUEUE_BUCKET)
     {
-        cout_warn("_remove", "could not remove, empty list");
-        return A_STAR_ERROR_32;
+        _bucket_unlink(pi);
+        _bucket_add(pi);
+        return;
     }
 
-    if (pi < 0 || pi > this->plc)
+    _swim(this->hp[pi]);
+}
+
+/* END Open list functions */
+
+/* START Bucket queue functions */
+
+void A_star::_bucket_add(a_star_index pi)
+{
+    std::uint32_t f = _getfcost(pi);
+    std::uint32_t b = f & (A_STAR_BUCKETS - 1);
+    a_star_index first = this->bh[b];
+
+    // LIFO inside a bucket: among equal f_costs the latest (deepest) node goes first
+    this->bn[pi] = first;
+    this->bp[pi] = A_STAR_ERROR_INDEX;
+    if (first != A_STAR_ERROR_INDEX)
+        this->bp[first] = pi;
+
+    this->bh[b] = pi;
+    this->bb[b >> 6] |= std::uint64_t(1) << (b & 63);
+    this->hp[pi] = b;
+
+    if (f < this->bq)
+        this->bq = f;
+}
+
+void A_star::_bucket_unlink(a_star_index pi)
+{
+    std::uint32_t b = static_cast<std::uint32_t>(this->hp[pi]);
+    a_star_index next = this->bn[pi];
+    a_star_index prev = this->bp[pi];
+
+    if (prev != A_STAR_ERROR_INDEX)
+        this->bn[prev] = next;
+    else
+        this->bh[b] = next;
+
+    if (next != A_STAR_ERROR_INDEX)
+        this->bp[next] = prev;
+
+    if (this->bh[b] == A_STAR_ERROR_INDEX)
+        this->bb[b >> 6] &= ~(std::uint64_t(1) << (b & 63));
+
+    this->hp[pi] = A_STAR_ERROR_INDEX;
+}
+
+a_star_index A_star::_bucket_pop()
+{
+    /**
+     * Buckets form a ring from the bucket of bq, the lowest open f_cost: a
+     * move raises f_cost by at most twice its step, so every open f_cost
+     * lies less than A_STAR_BUCKETS above bq and the first non-empty bucket
+     * after it holds the lowest. Skip whole words of empty buckets, f_costs
+     * mostly grow so this is amortized O(1). The word of bq is visited
+     * twice, its buckets past bq first and those before it once wrapped.
+     */
+    std::uint32_t start = this->bq & (A_STAR_BUCKETS - 1);
+    for (std::uint32_t i = 0; i <= A_STAR_BUCKETS / 64; i++)
     {
-        cout_warn("_remove", "could not remove, bad index");
-        return A_STAR_ERROR_32;
+        std::uint32_t w = ((start >> 6) + i) & (A_STAR_BUCKETS / 64 - 1);
+        std::uint64_t bits = this->bb[w];
+        if (i == 0)
+            bits &= ~std::uint64_t(0) << (start & 63);
+
+        if (bits == 0)
+            continue;
+
+        std::uint32_t b = (w << 6) | static_cast<std::uint32_t>(__builtin_ctzll(bits));
+        this->bq += (b - start) & (A_STAR_BUCKETS - 1);
+        a_star_index pi = this->bh[b];
+        _bucket_unlink(pi);
+        return pi;
     }
 
-    _exchange(pi, this->plc);
-    this->pxc[this->plc] = 0;
-    this->pyc[this->plc] = 0;
-    this->plc--;
+    this->bq = A_STAR_ERROR_32;
+    return A_STAR_ERROR_INDEX;
+}
 
-    _sink_cl(pi);
-    return _getfcost(this->pxc[this->pl], this->pyc[this->pl]);
+void A_star::_bucket_clear()
+{
+    for (std::uint32_t w = 0; w < A_STAR_BUCKETS / 64; w++)
+    {
+        std::uint64_t bits = this->bb[w];
+        while (bits != 0)
+        {
+            this->bh[(w << 6) | static_cast<std::uint32_t>(__builtin_ctzll(bits))] = A_STAR_ERROR_INDEX;
+            bits &= bits - 1;
+        }
+        this->bb[w] = 0;
+    }
+    this->bq = A_STAR_ERROR_32;
 }
 
-/* END Min binary heap functions */
+/* END Bucket queue functions */
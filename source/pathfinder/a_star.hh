@@ -11,91 +11,852 @@
  * - The first 16 bits correspond to the f_cost of the node
  * - The following 15 bits correspond to the g_cost of the node
  * - The last bit sets the enabled/disabled state of the node
+ *
+ * The map itself only keeps the state bit. The f_cost/g_cost of a search
+ * are kept apart, in A_star::sw, using the same layout, and a search word is
+ * only valid while its stamp in A_star::sg equals the current generation.
+ *
+ * Search words are A_STAR_COST_BITS * 2 wide: 16 (the layout above) or 32,
+ * for a 32 bit f_cost and a 31 bit g_cost in a 64 bit word. Wide costs let
+ * paths longer than 32767 moves (or heavily weighted ones) be found, at the
+ * price of twice the memory per search word.
+ *
+ * Built with A_STAR_PACKED_GRID set to 1, the map keeps nothing but that bit:
+ * a bitmap of one bit per cell, set for blocked cells, 32 times smaller.
  */
+#ifndef A_STAR_PACKED_GRID
+#define A_STAR_PACKED_GRID 0
+#endif
+
+/**
+ * Built with A_STAR_TILED_GRID set to 1, cells are numbered tile by tile
+ * instead of row by row: the map is cut into A_STAR_TILE x A_STAR_TILE
+ * tiles stored one after the other, cells row-major inside their tile. The
+ * 8 neighbors of most cells then lie in the same tile, a few cache lines
+ * apart at most, where row-major neighbors above and below are a whole
+ * stride away. Every per-cell buffer follows, as they all use A_star::_index.
+ * Packed, a tile is exactly one 64 bit word of the bitmap.
+ */
+#ifndef A_STAR_TILED_GRID
+#define A_STAR_TILED_GRID 0
+#endif
+
+// Side of a tile of A_STAR_TILED_GRID, in cells (a power of 2, tiles of 64 cells)
+#define A_STAR_TILE_SHIFT 3
+#define A_STAR_TILE (1u << A_STAR_TILE_SHIFT)
+
+/**
+ * Search statistics (see A_star::last_stats). The counters are a few
+ * increments per expansion, cheap enough to keep; built with A_STAR_STATS
+ * set to 0 they compile away and every statistic but expanded stays 0.
+ */
+#ifndef A_STAR_STATS
+#define A_STAR_STATS 1
+#endif
+
+#if A_STAR_STATS
+#define A_STAR_STAT(...) __VA_ARGS__
+#else
+#define A_STAR_STAT(...)
+#endif
 
 // Error code for functions that return std::uint32_t
 #define A_STAR_ERROR_32 0xFFFFFFFF
 // Error code for functions that return std::uint16_t
 #define A_STAR_ERROR_16 0xFFFF
 
+#ifndef A_STAR_COST_BITS
+#define A_STAR_COST_BITS 16
+#endif
+
+#if A_STAR_COST_BITS != 16 && A_STAR_COST_BITS != 32
+#error "A_STAR_COST_BITS must be 16 or 32"
+#endif
+
+// Error code for functions that return a_star_cost
+#define A_STAR_ERROR_COST static_cast<a_star_cost>(~a_star_cost(0))
+
+/**
+ * Cells are numbered by a_star_index, A_STAR_INDEX_BITS wide: 32 bits limit
+ * a map to stride * ys < 2^32 cells (about 65536 x 65536), 64 bits lift
+ * that for huge grids, at the price of twice the memory of every buffer
+ * holding cell indices (open list, bucket links, HPA* entrances).
+ */
+#ifndef A_STAR_INDEX_BITS
+#define A_STAR_INDEX_BITS 32
+#endif
+
+#if A_STAR_INDEX_BITS != 32 && A_STAR_INDEX_BITS != 64
+#error "A_STAR_INDEX_BITS must be 32 or 64"
+#endif
+
+// Error code for functions that return a_star_index
+#define A_STAR_ERROR_INDEX static_cast<a_star_index>(~a_star_index(0))
+
+// Largest g_cost and f_cost a search word holds, moves beyond the first are not taken
+#define A_STAR_GCOST_MAX ((a_star_word(1) << (A_STAR_COST_BITS - 1)) - 1)
+#define A_STAR_FCOST_MAX ((a_star_word(1) << A_STAR_COST_BITS) - 1)
+
 #define A_STAR_STATE_MASK 0b00000000000000000000000000000001
-#define A_STAR_GCOST_MASK 0b00000000000000001111111111111110
-#define A_STAR_FCOST_MASK 0b11111111111111110000000000000000
+#define A_STAR_GCOST_MASK (A_STAR_GCOST_MAX << 1)
+#define A_STAR_FCOST_MASK (A_STAR_FCOST_MAX << A_STAR_COST_BITS)
 
 #define A_STAR_STATE_MASK_NEGATE 0b11111111111111111111111111111110
-#define A_STAR_GCOST_MASK_NEGATE 0b11111111111111110000000000000001
-#define A_STAR_FCOST_MASK_NEGATE 0x0000FFFF
+#define A_STAR_GCOST_MASK_NEGATE (~A_STAR_GCOST_MASK)
+#define A_STAR_FCOST_MASK_NEGATE (~A_STAR_FCOST_MASK)
 
 #define A_STAR_NODE_ENABLED 0b11111111111111110000000000000001
 #define A_STAR_NODE_BLOCKED 0b11111111111111110000000000000000
-#define A_STAR_NODE_STARTER 0b00000000000000000000000000000001 // Starter node must have 0 f_cost
+#define A_STAR_NODE_STARTER a_star_word(1)     // Starter node must have 0 f_cost
+#define A_STAR_NODE_UNSEEN A_STAR_FCOST_MASK // Search word of a node not reached yet
+
+// Alignment (in bytes) of the map buffer and of every map row
+#define A_STAR_ALIGNMENT 64
+
+// Binary map files (see A_star::save), the payload starts on an A_STAR_ALIGNMENT boundary
+#define A_STAR_FILE_MAGIC "ASTARMAP"
+#define A_STAR_FILE_VERSION 1
+
+// Moves between neighbors, the parent link of a cell is the move that reached it
+#define A_STAR_DIR_E 0
+#define A_STAR_DIR_W 1
+#define A_STAR_DIR_S 2
+#define A_STAR_DIR_N 3
+#define A_STAR_DIR_SE 4
+#define A_STAR_DIR_NE 5
+#define A_STAR_DIR_NW 6
+#define A_STAR_DIR_SW 7
+#define A_STAR_DIR_NONE 8 // Start cell, no parent
+
+// Expansion strategies (see A_star::set_expansion)
+#define A_STAR_EXPAND_ALL 0 // Plain A*, every neighbor of an expanded node is considered
+#define A_STAR_EXPAND_JPS 1 // Jump Point Search, symmetric paths are pruned and straight runs skipped
+#define A_STAR_EXPAND_JPS_PLUS 2 // Jump Point Search reading jump distances from precomputed tables
+
+// Heuristic policies (see A_star::set_heuristic and heuristics.hh)
+#define A_STAR_HEURISTIC_CHEBYSHEV 0 // Every move costs 1
+#define A_STAR_HEURISTIC_MANHATTAN 1 // Straight moves cost 1, diagonal ones 2
+#define A_STAR_HEURISTIC_OCTILE 2    // Straight moves cost 10, diagonal ones 14
+#define A_STAR_HEURISTIC_EUCLIDEAN 3 // Octile moves, straight line estimate
+
+// Neighbor expansion kernels of plain A* (see A_star::set_simd)
+#define A_STAR_SIMD_OFF 0    // One check_node call per neighbor
+#define A_STAR_SIMD_SCALAR 1 // Successor mask computed in one scalar pass
+#define A_STAR_SIMD_SSE4 2   // Successor mask from SSE4.1 compares
+#define A_STAR_SIMD_AVX2 3   // Successor mask from AVX2 row loads and permutes
+#define A_STAR_SIMD_AUTO 4   // Fastest kernel the CPU supports
+
+// Bidirectional search modes (see A_star::set_bidirectional)
+#define A_STAR_BIDIR_OFF 0       // Forward search only
+#define A_STAR_BIDIR_ALTERNATE 1 // Forward and backward frontiers expanded in turns on the calling thread
+#define A_STAR_BIDIR_THREADS 2   // Forward and backward frontiers on two threads
+
+// Free runs along a cluster border at least this long get an entrance at each end, shorter ones one in the middle
+#define A_STAR_ENTRANCE_SPLIT 6
 
+// Rows per band of the parallel component labelling (see A_star::set_components), whole tiles
+#define A_STAR_CC_BAND 64
+
+// D* Lite restarts from scratch before its key modifier can overflow
+#define A_STAR_LITE_KM_MAX 0x7FFFFFFF
+
+// Smallest open list capacity reserved up front
+#define A_STAR_OPEN_LIST_MIN 1024
+
+// Open list backends (see A_star::set_queue)
+#define A_STAR_QUEUE_HEAP 0   // Binary min heap, O(log n) push/pop, any cost distribution
+#define A_STAR_QUEUE_BUCKET 1 // One bucket per f_cost, O(1) push and amortized O(1) pop
+// Number of buckets of A_STAR_QUEUE_BUCKET, used as a ring indexed by f_cost % A_STAR_BUCKETS
+#define A_STAR_BUCKETS 65536
+
+#include "arena.hh"
+#include "heuristics.hh"
+#include "work_pool.hh"
+
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if A_STAR_COST_BITS == 16
+typedef std::uint16_t a_star_cost; // f_cost/g_cost of a search
+typedef std::uint32_t a_star_word; // Search word, f_cost and g_cost packed
+#else
+typedef std::uint32_t a_star_cost;
+typedef std::uint64_t a_star_word;
+#endif
+
+#if A_STAR_INDEX_BITS == 32
+typedef std::uint32_t a_star_index; // Cell index (see A_star::_index)
+#else
+typedef std::uint64_t a_star_index;
+#endif
 
 class A_star
 {
 private:
-    std::uint32_t **map;  // Map points
-    std::uint32_t xs, ys; // Map resolution (xs*ys must be bounded to be a 32bit unsigned integer)
     /**
+     * The map is a single aligned, row-major buffer. The cell (px, py) lives at
+     * map[py * stride + px], stride being xs rounded up so every row starts on
+     * an A_STAR_ALIGNMENT boundary. Packed, the cell pi is bit (pi % 64) of
+     * map[pi / 64] instead, with the same stride. Tiled (A_STAR_TILED_GRID),
+     * the index of a cell is computed by A_star::_index instead, over ys
+     * rounded up to whole tiles.
+     */
+#if A_STAR_PACKED_GRID
+    std::uint64_t *map = nullptr; // Obstacle bitmap, bit set for a blocked cell
+#else
+    std::uint32_t *map = nullptr; // Map cells
+#endif
+    /**
+     * Terrain costs, one byte per cell with the indexing of A_star::map but
+     * kept apart from it, so obstacle tests read as little memory as before.
+     * Null while every cell costs 1 (see A_star::set_cost).
+     */
+    std::uint8_t *tc = nullptr;
+    std::uint32_t xs = 0, ys = 0; // Map resolution (stride*ys must fit in an a_star_index)
+    std::uint32_t stride = 0;     // Distance (in cells) between two consecutive rows
+    bool mo = false;              // The map is owned, and not borrowed from another planner
+
+    /**
+     * Map file the packed obstacle layer is read from in place, mapped
+     * privately: its pages are shared with every process mapping the same
+     * file until toggletile writes to one, which only copies that page.
      *
-     * px = list of output points' x coord
-     * py = list of output points' y coord
-     * ps = size of both lists
+     * mf = start of the mapping, null when the map was allocated
+     * mz = length of the mapping in bytes
+     */
+    void *mf = nullptr;
+    std::size_t mz = 0;
+    /**
+     * Owns every search buffer below. It is sized once from the map resolution
+     * and only grows (geometrically) if the open list outgrows its reservation,
+     * so run() does not touch the heap once warmed up.
+     */
+    arena mem;
+
+    /**
+     * Per-cell search state, same indexing as A_star::map. A cell's entries
+     * in sw, hp and cl are only valid while sg holds the current generation,
+     * so a new search starts by bumping A_star::gen instead of clearing.
+     *
+     * sg = generation stamp of every cell
+     * sw = search word (f_cost/g_cost) of every cell
+     * gen = generation of the current search
+     */
+    std::uint32_t *sg = nullptr, gen = 0;
+    a_star_word *sw = nullptr;
+
+    /**
+     *
+     * pc = open list (binary heap) of cell indices
+     * hp = heap slot of every cell in A_star::pc, A_STAR_ERROR_INDEX when not open (map sized)
+     * ps = capacity of the open list (grows up to the number of cells)
      * pl = current last element index (length = pl)
-     * plc = current last element index of closed list (length = plc)
      */
-    std::uint32_t *px, *py, *pxc, *pyc, ps, pl, plc;
+    a_star_index *pc = nullptr, *hp = nullptr, ps = 0, pl = 0;
+
+    /**
+     * Bucket queue, used instead of the heap when qk is A_STAR_QUEUE_BUCKET.
+     * Open cells are chained per f_cost, and A_star::hp holds the bucket of
+     * every open cell instead of a heap slot. Allocated on first selection.
+     * Buckets form a ring indexed by f_cost % A_STAR_BUCKETS, so 32 bit costs fit.
+     *
+     * qk = open list backend in use
+     * bn = next cell in the same bucket (map sized)
+     * bp = previous cell in the same bucket (map sized)
+     * bh = first cell of every bucket, A_STAR_ERROR_INDEX when empty
+     * bb = bitmap of the non-empty buckets
+     * bq = lowest f_cost that may be open, A_STAR_ERROR_32 once empty
+     */
+    std::uint8_t qk = A_STAR_QUEUE_HEAP;
+    a_star_index *bn = nullptr, *bp = nullptr, *bh = nullptr;
+    std::uint32_t bq = 0;
+    std::uint64_t *bb = nullptr;
+
+    /**
+     * Closed set, one bit per cell: bit (pi % 64) of cl[pi / 64] is set once
+     * the cell pi has been expanded. Same indexing as A_star::map.
+     */
+    std::uint64_t *cl = nullptr;
+    std::size_t cls = 0; // Number of words in A_star::cl
+
+    /**
+     * Parent links, one A_STAR_DIR_* code per cell (map sized, valid while
+     * the cell's stamp is current). Following them backwards from a reached
+     * cell leads to rs, the start cell of the last search.
+     */
+    std::uint8_t *pd = nullptr;
+    a_star_index rs = A_STAR_ERROR_INDEX;
+
+    // Offsets of the A_STAR_DIR_* moves
+    static constexpr std::int32_t dir_x[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+    static constexpr std::int32_t dir_y[8] = {0, 0, 1, -1, 1, -1, -1, 1};
+
+    std::uint8_t xk = A_STAR_EXPAND_ALL; // Expansion strategy in use
+
+    /**
+     * ek = heuristic policy of A_star::run
+     * es/ed = cost of a straight/diagonal move in the last search, to walk its path back
+     */
+    std::uint8_t ek = A_STAR_HEURISTIC_CHEBYSHEV;
+    std::uint16_t es = 1, ed = 1;
+
+    /**
+     * @brief  Successor kernel: looks at the 8 neighbors of an expanded cell at
+     *         once and returns a mask, bit A_STAR_DIR_* set for every neighbor
+     *         worth pushing (in bounds, free, and unseen or reached cheaper than
+     *         before). Only reads the search state, A_star::_expand updates it.
+     * @param  {pi} a_star_index : index of the expanded cell (see A_star::_index)
+     * @param  {gcost} a_star_cost : g_cost of the expanded cell
+     * @param  {straight} std::uint16_t : cost of a straight move
+     * @param  {diagonal} std::uint16_t : cost of a diagonal move
+     */
+    typedef std::uint32_t (*successor_kernel)(const A_star *planner, a_star_index pi, std::uint32_t x, std::uint32_t y,
+                                             a_star_cost gcost, std::uint16_t straight, std::uint16_t diagonal);
+
+    /**
+     * sk = kernel level in use, sf = its successor kernel (null with A_STAR_SIMD_OFF)
+     */
+    std::uint8_t sk = A_STAR_SIMD_OFF;
+    successor_kernel sf = nullptr;
+
+    /***** Successor kernels (a_star_simd.cc) *****/
+
+    static std::uint32_t _successors_scalar(const A_star *planner, a_star_index pi, std::uint32_t x, std::uint32_t y,
+                                            a_star_cost gcost, std::uint16_t straight, std::uint16_t diagonal);
+    static std::uint32_t _successors_sse4(const A_star *planner, a_star_index pi, std::uint32_t x, std::uint32_t y,
+                                          a_star_cost gcost, std::uint16_t straight, std::uint16_t diagonal);
+    static std::uint32_t _successors_avx2(const A_star *planner, a_star_index pi, std::uint32_t x, std::uint32_t y,
+                                          a_star_cost gcost, std::uint16_t straight, std::uint16_t diagonal);
+
+    /**
+     * JPS+ jump tables, built the first time A_STAR_EXPAND_JPS_PLUS is
+     * selected and kept in sync by toggletile from then on.
+     * jt[pi * 8 + dir] is the number of steps from the cell pi to the next
+     * jump point in direction dir when positive, or minus the number of free
+     * cells before a wall or the map border otherwise.
+     *
+     */
+    std::int32_t *jt = nullptr;
+
+    /**
+     * HPA* abstraction, built by set_hierarchy. The map is cut into square
+     * clusters of hc cells. Every entrance is a pair of free cells facing
+     * each other across a cluster border; each cell of the pair is an
+     * abstract node of its cluster, linked at cost 1 to its peer and to the
+     * other nodes of the cluster through cached distances.
+     */
+    struct hpa_cluster
+    {
+        std::vector<a_star_index> cell;  // Entrance cells inside the cluster (see A_star::_index)
+        std::vector<a_star_index> peer;  // Cell across the border of every entrance
+        std::vector<std::uint16_t> dist; // Distances between entrances inside the cluster, A_STAR_ERROR_16 if unreachable
+        bool dirty = true;               // Entrances or distances must be computed again
+    };
+
+    /**
+     * hk = clusters, row-major
+     * hq = dirty clusters, rebuilt before the next hierarchical query
+     * ho = first abstract node of every cluster, the start and target of a query follow the last one
+     * hc = cluster side (0 while there is no hierarchy), hw/hh = clusters per row/column
+     */
+    std::vector<hpa_cluster> hk;
+    std::vector<std::uint32_t> hq, ho;
+    std::uint32_t hc = 0, hw = 0, hh = 0;
+
+    /**
+     * Abstract search scratch, indexed by abstract node and only valid while
+     * hs holds the current hierarchical query number hn.
+     *
+     * hs = stamp, hg = g_cost, hr = parent node, hn = query number
+     * hx = cell of every node, hy = cluster of every node
+     * ht = distance from every node of the target's cluster to the target
+     * ha = abstract path of the last query, target first
+     */
+    std::vector<std::uint32_t> hs, hg, hr, hy, ht, ha;
+    std::vector<a_star_index> hx;
+    std::uint32_t hn = 0;
+
+    /**
+     * Breadth first search inside one cluster, indexed by cell of the cluster.
+     *
+     * kd = distance from the source, kp = A_STAR_DIR_* move that reached the cell, kq = queue
+     */
+    std::vector<std::uint16_t> kd;
+    std::vector<std::uint8_t> kp;
+    std::vector<std::uint32_t> kq;
+
+    /**
+     * Batch queries (see A_star::run_batch). Worker 0 searches with this
+     * planner, every other worker with a search context of its own in wk,
+     * which borrows the map and the jump tables of this planner read only.
+     *
+     * tp = thread pool, created by set_threads or by the first batch
+     * wk = search contexts of workers 1 and up
+     */
+    std::unique_ptr<work_pool> tp;
+    std::vector<std::unique_ptr<A_star>> wk;
+
+    /**
+     * Bidirectional search (see A_star::set_bidirectional). The forward
+     * frontier searches with this planner, the backward one with dw, a
+     * context borrowing the map. Both publish the g_cost of every cell they
+     * close in dt, two entries per cell (forward at 2 * pi, backward next to
+     * it): the g_cost in bits 0-31, stamped in bits 32-63 with the query
+     * number dg.
+     *
+     * dm = mode, dc = meeting cell of the last run, A_STAR_ERROR_INDEX if it was not bidirectional
+     * dp = two worker pool of A_STAR_BIDIR_THREADS
+     */
+    std::uint8_t dm = A_STAR_BIDIR_OFF;
+    a_star_index dc = A_STAR_ERROR_INDEX;
+    std::uint32_t dg = 0;
+    std::unique_ptr<A_star> dw;
+    std::atomic<std::uint64_t> *dt = nullptr;
+    std::unique_ptr<work_pool> dp;
+
+    /**
+     * @brief Bidirectional version of A_star::run, see A_star::set_bidirectional
+     */
+    bool _run_bidir(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty);
+
+    /**
+     * @brief Runs one frontier of a bidirectional search, see work_pool::task
+     * @param  {index} std::uint32_t : 0 forward, 1 backward
+     */
+    static void _bidir_side(void *arg, std::uint32_t worker, std::uint32_t index);
+
+    /**
+     * @brief Expands the next node of one frontier
+     * @param  {arg} void* : state shared by both frontiers
+     * @param  {side} std::uint32_t : 0 forward, 1 backward
+     * @returns false once the frontier is done, the search being over
+     */
+    static bool _bidir_step(void *arg, std::uint32_t side);
+
+    /**
+     * @brief Records in A_star::dt that a frontier closed a cell
+     * @param  {pi} a_star_index : index of the cell (see A_star::_index)
+     * @param  {side} std::uint32_t : 0 forward, 1 backward
+     * @param  {gcost} a_star_cost : g_cost of the cell in that frontier
+     * @returns The g_cost of the cell in the other frontier, A_STAR_ERROR_COST if it did not close it
+     */
+    a_star_cost _meet(a_star_index pi, std::uint32_t side, a_star_cost gcost);
+
+    /**
+     * D* Lite (see A_star::run_incremental). The search runs backwards from
+     * the target lt. Every cell keeps lg, its distance to the target, and lr,
+     * the lookahead min(lg + 1) over its free neighbors (A_STAR_ERROR_16 when
+     * infinite); cells where they differ are queued in lq. Entry keys are not
+     * refreshed when the start moves: lk accumulates the heuristic shift, and
+     * an entry popped with an outdated key is queued again.
+     *
+     * lg/lr = g_cost/lookahead planes (map sized, allocated on first use),
+     *         16 bit whatever A_STAR_COST_BITS, so replanned paths stay under 65535 moves
+     * lt = target, lo = start of the last replan, lk = key modifier
+     * lq = binary min heap of (key, cell), lc = cells toggled since the last replan
+     */
+    typedef std::pair<std::uint64_t, a_star_index> lite_entry;
+    std::uint16_t *lg = nullptr, *lr = nullptr;
+    a_star_index lt = A_STAR_ERROR_INDEX, lo = A_STAR_ERROR_INDEX;
+    std::uint32_t lk = 0;
+    std::vector<lite_entry> lq;
+    std::vector<a_star_index> lc;
+
+    /**
+     * @brief Drops the previous plan and queues the target of a new one
+     * @returns false if the planes cannot be allocated
+     */
+    bool _lite_reset(a_star_index si, a_star_index ti);
+
+    /**
+     * @brief D* Lite key of a cell: (min(lg, lr) + distance to the start + lk, min(lg, lr))
+     */
+    std::uint64_t _lite_key(a_star_index pi);
+
+    /**
+     * @brief Queues a cell if its g_cost and lookahead differ
+     */
+    void _lite_queue(a_star_index pi);
+
+    /**
+     * @brief Recomputes the lookahead of a cell from its neighbors, then queues it if needed
+     */
+    void _lite_update(a_star_index pi);
+
+    /**
+     * @brief Settles queued cells until the start is consistent and no key is below its own
+     */
+    void _lite_compute();
+
+    /**
+     * Connected components (see A_star::set_components), 8-connected with
+     * corners cut like the searches. Every free cell carries a label in cc,
+     * and labels are the elements of a union-find forest: two free cells are
+     * connected when their labels have the same root. Freeing a cell unions
+     * the labels around it; blocking one walks the pieces it may split
+     * apart and gives all of them but the last one a label of their own,
+     * unless that walk grows too long: the labels are then out of date
+     * until the next query labels the map afresh. Lookups only read, so
+     * batch workers may share them.
+     *
+     * ce = labels enabled and kept up to date, cs = labels out of date
+     * cc = label of every cell, A_STAR_ERROR_INDEX for blocked cells (map sized, allocated on first use)
+     * cu = parent of every label, cr = rank of every root label
+     * cp = labelling pool when there are no batch threads, created by the first labelling
+     * cq = queue of every walk, ch = cells walked (open addressing), co = their walk, ct = slots of ch in use
+     */
+    bool ce = false, cs = false;
+    a_star_index *cc = nullptr;
+    std::vector<a_star_index> cu;
+    std::vector<std::uint8_t> cr;
+    std::unique_ptr<work_pool> cp;
+    std::vector<a_star_index> cq[8];
+    std::vector<a_star_index> ch;
+    std::vector<std::uint8_t> co;
+    std::vector<std::size_t> ct;
+
+    /**
+     * @brief  Labels the whole map: union-find over bands of rows on a thread
+     *         pool, then the bands are joined and the labels numbered densely
+     * @returns false if the labels cannot be allocated
+     */
+    bool _cc_build();
+
+    /**
+     * @brief  Runs one phase of A_star::_cc_build over a band, see work_pool::task
+     */
+    static void _cc_band(void *arg, std::uint32_t worker, std::uint32_t index);
+
+    /**
+     * @brief  Updates the labels around a cell that changed state
+     */
+    void _cc_update(std::uint32_t px, std::uint32_t py);
+
+    /**
+     * @brief  Root of a label, read only
+     */
+    a_star_index _cc_find(a_star_index label) const
+    {
+        while (this->cu[label] != label)
+            label = this->cu[label];
+        return label;
+    }
+
+    /**
+     * @brief  Claims a cell for a walk of A_star::_cc_update
+     * @returns true if the cell was not walked yet, else false with the walk it belongs to in owner
+     */
+    bool _cc_claim(a_star_index ci, std::uint32_t walk, std::uint32_t &owner);
+
+    /**
+     * @brief  Joins the sets of two labels, by rank
+     * @returns The root of the joined set
+     */
+    a_star_index _cc_union(a_star_index a, a_star_index b);
+
+    /**
+     * @brief  false if the labels prove that no path joins two cells. A blocked
+     *         start is left to the search, which may step off it.
+     */
+    bool _reachable(a_star_index si, a_star_index ti) const;
+
+    /**
+     * @brief  Search context for a batch worker: shares the map of another
+     *         planner, owns only its search buffers
+     */
+    explicit A_star(const A_star *shared);
+
+    /**
+     * @brief Runs one query of a batch, see work_pool::task
+     */
+    static void _batch(void *arg, std::uint32_t worker, std::uint32_t index);
+
+    std::uint32_t ne = 0; // Number of nodes expanded by the last run
 
     /***** Debugging and error checking *****/
 
     bool _check_map();
     bool _check_coords(std::uint32_t px, std::uint32_t py);
-    bool check_node(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty, std::uint16_t gcost);
+    bool _in_bounds(std::uint32_t px, std::uint32_t py) const { return px < this->xs && py < this->ys; }
+    template <typename H = heuristic_chebyshev>
+    bool check_node(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty, a_star_cost gcost, std::uint8_t dir,
+                    a_star_cost step = 1);
+
+    /**
+     * @brief Chebyshev heuristic, number of moves between two cells on an
+     *        empty map. Jump point, hierarchical, bidirectional and incremental
+     *        searches always price moves this way.
+     */
+    static std::uint32_t _distance(std::uint32_t x1, std::uint32_t y1, std::uint32_t x2, std::uint32_t y2);
+
+    /***** Jump Point Search (a_star_jps.cc) *****/
+
+    /**
+     * @brief Pushes the jump points reachable from an expanded node, only
+     *        following the directions its parent link leaves unpruned
+     * @param  {x} std::uint32_t : X coordinate of the expanded node
+     * @param  {y} std::uint32_t : Y coordinate of the expanded node
+     * @param  {tx} std::uint32_t : target X position
+     * @param  {ty} std::uint32_t : target Y position
+     * @param  {gcost} a_star_cost : g_cost of the expanded node
+     */
+    void _expand_jps(std::uint32_t x, std::uint32_t y, std::uint32_t tx, std::uint32_t ty, a_star_cost gcost);
+
+    /**
+     * @brief Moves from a cell in one direction until a jump point: the
+     *        target, a cell with a forced neighbor or, diagonally, a cell
+     *        from which a straight jump finds one
+     * @param  {x} std::uint32_t& : X coordinate, updated to the jump point
+     * @param  {y} std::uint32_t& : Y coordinate, updated to the jump point
+     * @param  {dir} std::uint8_t : A_STAR_DIR_* to move in
+     * @returns false if a wall or the map border is hit first
+     */
+    bool _jump(std::uint32_t &x, std::uint32_t &y, std::uint8_t dir, std::uint32_t tx, std::uint32_t ty);
+
+    /**
+     * @brief Same as A_star::_jump, reading the distance from A_star::jt
+     *        instead of scanning the map
+     */
+    bool _jump_table(std::uint32_t &x, std::uint32_t &y, std::uint8_t dir, std::uint32_t tx, std::uint32_t ty);
+
+    /**
+     * @brief Returns true if a cell entered with the move (dx, dy) has a
+     *        neighbor that only a path through it reaches optimally
+     */
+    bool _forced(std::uint32_t x, std::uint32_t y, std::int32_t dx, std::int32_t dy);
+
+    /**
+     * @brief  Allocates the jump tables and fills them for the whole map
+     * @returns false if they cannot be allocated
+     */
+    bool _jps_build();
+
+    /**
+     * @brief Recomputes the jump tables around a cell that changed state:
+     *        the three rows and columns through it, then the diagonal
+     *        entries leading to the cells whose inputs changed
+     */
+    void _jps_update(std::uint32_t px, std::uint32_t py);
+
+    /**
+     * @brief Jump table entry of a cell, computed from the entries of the
+     *        next cell in direction dir
+     */
+    std::int32_t _jps_entry(std::uint32_t x, std::uint32_t y, std::uint8_t dir);
+
+    /**
+     * @brief Recomputes one direction of the jump tables along a line of cells
+     * @param  {x} std::uint32_t : X coordinate of the last cell of the line in direction dir
+     * @param  {y} std::uint32_t : Y coordinate of the last cell of the line in direction dir
+     * @param  {dir} std::uint8_t : A_STAR_DIR_* recomputed
+     * @param  {count} std::uint32_t : number of cells of the line
+     * @param  {ripple} bool : update the diagonal entries depending on straight entries that changed
+     */
+    void _jps_sweep(std::uint32_t x, std::uint32_t y, std::uint8_t dir, std::uint32_t count, bool ripple);
+
+    /**
+     * @brief Recomputes the diagonal entries that lead to a cell, walking
+     *        back along each diagonal while they change
+     */
+    void _jps_ripple(std::uint32_t x, std::uint32_t y);
+
+    /**
+     * @brief Blocked test that treats cells outside the map as blocked
+     */
+    bool _isfree(std::uint32_t px, std::uint32_t py) { return _in_bounds(px, py) && !_isblocked(_index(px, py)); }
+
+    /***** Hierarchical search (a_star_hpa.cc) *****/
+
+    /**
+     * @brief Cluster holding a cell
+     */
+    std::uint32_t _hpa_of(std::uint32_t px, std::uint32_t py) const { return (py / this->hc) * this->hw + px / this->hc; }
+
+    /**
+     * @brief Computes the entrances of a cluster and the distances between them
+     * @param  {k} std::uint32_t : index of the cluster in A_star::hk
+     */
+    void _hpa_build(std::uint32_t k);
+
+    /**
+     * @brief Rebuilds the dirty clusters and numbers the abstract nodes again
+     */
+    void _hpa_refresh();
+
+    /**
+     * @brief Appends the entrances of a border to a cluster
+     * @param  {k} std::uint32_t : index of the cluster in A_star::hk
+     * @param  {x} std::uint32_t : X coordinate of the first cell of the border on the low side
+     * @param  {y} std::uint32_t : Y coordinate of the first cell of the border on the low side
+     * @param  {vertical} bool : the border runs down a column, the high side being on its right
+     * @param  {length} std::uint32_t : number of cells of the border
+     * @param  {high} bool : the cluster lies on the high side (right or below) of the border
+     */
+    void _hpa_border(std::uint32_t k, std::uint32_t x, std::uint32_t y, bool vertical, std::uint32_t length, bool high);
+
+    /**
+     * @brief Breadth first search from a cell over the cells of its cluster,
+     *        filling A_star::kd and A_star::kp
+     * @param  {k} std::uint32_t : index of the cluster in A_star::hk
+     * @param  {pi} a_star_index : index of the source cell (see A_star::_index)
+     */
+    void _hpa_bfs(std::uint32_t k, a_star_index pi);
+
+    /**
+     * @brief Index of a cell in A_star::kd and A_star::kp
+     */
+    std::uint32_t _hpa_local(a_star_index pi) const
+    {
+        return (_row(pi) % this->hc) * this->hc + _column(pi) % this->hc;
+    }
+
+    /**
+     * @brief Relaxes an abstract node of the current hierarchical query
+     * @param  {node} std::uint32_t : abstract node
+     * @param  {g} std::uint32_t : cost through parent
+     * @param  {parent} std::uint32_t : abstract node it is reached from
+     * @returns true if the cost went down and the node must be pushed again
+     */
+    bool _hpa_relax(std::uint32_t node, std::uint32_t g, std::uint32_t parent);
 
     /***** Memory allocation *****/
 
     /**
-     * @brief  Allocate memory for the map
+     * @brief  Row stride of a map resolution, checking that the map can be indexed
+     * @param  {stride} std::uint32_t& : receives xs rounded up to whole A_STAR_ALIGNMENT rows
+     * @returns false if the stride * ys cells (ys in whole tiles when tiled) do not fit in an a_star_index,
+     *          or their buffers in a std::size_t
+     */
+    static bool _layout(std::uint32_t xs, std::uint32_t ys, std::uint32_t &stride);
+
+    /**
+     * @brief  Allocate memory for the map, then for the search buffers
      */
     void _loadmap();
 
     /**
-     * @brief Get an element from the open list
-     * @param  {px} std::uint32_t : X coordinate of the point
-     * @param  {py} std::uint32_t : Y coordinate of the point
-     * @returns The index of the element relative to the list
+     * @brief  Carve the search buffers for the map out of A_star::mem
+     */
+    void _loadsearch();
+
+    /**
+     * @brief  Reads the map from a file written by A_star::save (a_star_file.cc)
+     * @returns false if the file cannot be read or does not fit this build
+     */
+    bool _loadfile(const char *path);
+
+    /**
+     * @brief  Index (see A_star::_index) of the cell pi of a map file, whose bitmap is row-major
+     */
+    a_star_index _cell(std::size_t pi) const;
+
+    /**
+     * @brief  Unmaps the map file of A_star::mf
      */
-    std::uint32_t get_open_list(std::uint32_t px, std::uint32_t py);
+    void _closefile();
 
     /**
-     * @brief Get an element from the closed list
+     * @brief Get an element from the open list in O(1) through A_star::hp
      * @param  {px} std::uint32_t : X coordinate of the point
      * @param  {py} std::uint32_t : Y coordinate of the point
-     * @returns The index of the element relative to the list
+     * @returns The index of the element relative to the list, A_star::pl if it is not open
      */
-    std::uint32_t get_closed_list(std::uint32_t px, std::uint32_t py);
+    a_star_index get_open_list(std::uint32_t px, std::uint32_t py);
 
     /**
-     * @brief check for an element from the open list
+     * @brief check for an element from the open list in O(1) through A_star::hp
      * @param  {px} std::uint32_t : X coordinate of the point
      * @param  {py} std::uint32_t : Y coordinate of the point
      */
     bool in_open_list(std::uint32_t px, std::uint32_t py);
 
     /**
-     * @brief check for an element from the closed list
+     * @brief check for an element from the closed set
      * @param  {px} std::uint32_t : X coordinate of the point
      * @param  {py} std::uint32_t : Y coordinate of the point
      */
     bool in_closed_list(std::uint32_t px, std::uint32_t py);
 
     /**
-     * @brief  Allocate memory for the points
-     * @param  {xs} std::uint32_t : X-Resolution of the points
-     * @param  {ys} std::uint32_t : Y-Resolution of the points
+     * @brief Closed set bit of a cell
+     * @param  {pi} a_star_index : index of the cell (see A_star::_index)
+     */
+    bool _isclosed(a_star_index pi) const { return this->sg[pi] == this->gen && ((this->cl[pi >> 6] >> (pi & 63)) & 1); }
+
+    /**
+     * @brief Adds a cell to the closed set
+     * @param  {pi} a_star_index : index of the cell (see A_star::_index)
+     */
+    void _setclosed(a_star_index pi) { this->cl[pi >> 6] |= std::uint64_t(1) << (pi & 63); }
+
+    /**
+     * @brief  Empties the open list for a new search
+     */
+    void _loadpnt();
+
+    /**
+     * @brief  A_star::run once the query is checked: picks the search
+     *         (bidirectional or not, heuristic policy) and runs it
+     */
+    bool _dispatch(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty);
+
+    /**
+     * @brief  Starts a new search from a cell: fresh generation, start cell open
+     * @param  {straight} std::uint16_t : cost of a straight move in this search
+     * @param  {diagonal} std::uint16_t : cost of a diagonal move in this search
      */
-    void _loadpnt(std::uint32_t xs, std::uint32_t ys);
+    void _begin(std::uint32_t sx, std::uint32_t sy, std::uint16_t straight = 1, std::uint16_t diagonal = 1);
+
+    /**
+     * @brief  f_cost of a cell reached at g_cost, held at A_STAR_FCOST_MAX
+     *         rather than wrapped around when the estimate does not fit
+     */
+    template <typename H>
+    static a_star_cost _fcost(std::uint32_t x, std::uint32_t y, std::uint32_t tx, std::uint32_t ty, a_star_cost gcost)
+    {
+        std::uint64_t f = std::uint64_t(H::distance(heuristic_delta(x, tx), heuristic_delta(y, ty))) + gcost;
+        return static_cast<a_star_cost>(f < A_STAR_FCOST_MAX ? f : A_STAR_FCOST_MAX);
+    }
+
+    /**
+     * @brief  Cost of the move dir that entered the cell pi in the last search
+     */
+    a_star_cost _step(a_star_index pi, std::uint8_t dir) const
+    {
+        a_star_cost base = dir < A_STAR_DIR_SE ? this->es : this->ed;
+        return this->tc != nullptr ? static_cast<a_star_cost>(base * this->tc[pi]) : base;
+    }
+
+    /**
+     * @brief  A_star::run with the heuristic policy H, inlined in the expansion loop
+     */
+    template <typename H>
+    bool _search(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty);
+
+    /**
+     * @brief  Pushes the 8 neighbors of an expanded node (plain A*), priced by the policy H
+     * @param  {gcost} a_star_cost : g_cost of the expanded node
+     */
+    template <typename H = heuristic_chebyshev>
+    void _expand(std::uint32_t x, std::uint32_t y, std::uint32_t tx, std::uint32_t ty, a_star_cost gcost);
+
+    /**
+     * @brief  A_star::_expand on a map with terrain costs: every move costs its
+     *         straight or diagonal price times the cost of the cell it enters
+     * @param  {gcost} a_star_cost : g_cost of the expanded node
+     */
+    template <typename H>
+    void _expand_weighted(std::uint32_t x, std::uint32_t y, std::uint32_t tx, std::uint32_t ty, a_star_cost gcost);
+
+    /**
+     * @brief  Doubles the open list capacity, taking the new list from A_star::mem
+     * @returns false if the list cannot grow
+     */
+    bool _growpnt();
 
     /**
      * @brief Free map memory
@@ -103,66 +864,121 @@ private:
     void _freemap();
 
     /**
-     * @brief Free all output points
+     * @brief Keeps the data derived from the map in sync after a cell changed state
+     * @param  {px} std::uint32_t : X Position of the tile
+     * @param  {py} std::uint32_t : Y Position of the tile
      */
-    void _freepnt();
+    void _changed(std::uint32_t px, std::uint32_t py);
 
     /***** Nodes and map functions *****/
 
     /**
-     * @brief Get f_cost of the point in the map
-     * @param  {px} std::uint32_t : X coordinate of the point
-     * @param  {py} std::uint32_t : Y coordinate of the point
-     * @returns The f_cost of the node
+     * @brief Starts a new search generation, invalidating all search words in O(1)
+     */
+    void _newgen();
+
+    /**
+     * @brief Resets the search data of a cell the first time the current search reaches it
+     * @param  {pi} a_star_index : index of the cell (see A_star::_index)
      */
-    std::uint16_t _getfcost(std::uint32_t px, std::uint32_t py);
+    void _touch(a_star_index pi);
 
     /**
-     * @brief Get g_cost of the point in the map
+     * @brief Get the linear index of a cell
      * @param  {px} std::uint32_t : X coordinate of the point
      * @param  {py} std::uint32_t : Y coordinate of the point
+     * @returns The index of the cell in A_star::map
+     */
+#if A_STAR_TILED_GRID
+    a_star_index _index(std::uint32_t px, std::uint32_t py) const
+    {
+        // Tile rows of stride * A_STAR_TILE cells, tiles of A_STAR_TILE^2 cells, then the cell in its tile
+        const std::uint32_t low = A_STAR_TILE - 1;
+        return ((a_star_index(py >> A_STAR_TILE_SHIFT) * this->stride + (px & ~low) + (py & low)) << A_STAR_TILE_SHIFT) | (px & low);
+    }
+#else
+    a_star_index _index(std::uint32_t px, std::uint32_t py) const { return a_star_index(py) * this->stride + px; }
+#endif
+
+    /**
+     * @brief Coordinates of a cell, the inverse of A_star::_index
+     * @param  {pi} a_star_index : index of the cell
+     */
+#if A_STAR_TILED_GRID
+    std::uint32_t _column(a_star_index pi) const
+    {
+        a_star_index band = a_star_index(this->stride) << A_STAR_TILE_SHIFT;
+        return static_cast<std::uint32_t>((pi % band) >> (2 * A_STAR_TILE_SHIFT) << A_STAR_TILE_SHIFT | (pi & (A_STAR_TILE - 1)));
+    }
+    std::uint32_t _row(a_star_index pi) const
+    {
+        a_star_index band = a_star_index(this->stride) << A_STAR_TILE_SHIFT;
+        return static_cast<std::uint32_t>(pi / band << A_STAR_TILE_SHIFT | (pi >> A_STAR_TILE_SHIFT & (A_STAR_TILE - 1)));
+    }
+#else
+    std::uint32_t _column(a_star_index pi) const { return static_cast<std::uint32_t>(pi % this->stride); }
+    std::uint32_t _row(a_star_index pi) const { return static_cast<std::uint32_t>(pi / this->stride); }
+#endif
+
+    /**
+     * @brief Number of cells of every map sized buffer, padding included
+     */
+    std::size_t _cells() const
+    {
+#if A_STAR_TILED_GRID
+        return static_cast<std::size_t>(this->stride) * ((std::size_t(this->ys) + A_STAR_TILE - 1) & ~std::size_t(A_STAR_TILE - 1));
+#else
+        return static_cast<std::size_t>(this->stride) * this->ys;
+#endif
+    }
+
+    /**
+     * @brief Get f_cost of the point in the current search
+     * @param  {pi} a_star_index : index of the cell (see A_star::_index)
      * @returns The f_cost of the node
      */
-    std::uint16_t _getgcost(std::uint32_t px, std::uint32_t py);
+    a_star_cost _getfcost(a_star_index pi);
 
     /**
-     * @brief Set f_cost of the point in the map
-     * @param  {px} std::uint32_t : X coordinate of the point
-     * @param  {py} std::uint32_t : Y coordinate of the point
+     * @brief Get g_cost of the point in the current search
+     * @param  {pi} a_star_index : index of the cell (see A_star::_index)
+     * @returns The g_cost of the node
+     */
+    a_star_cost _getgcost(a_star_index pi);
+
+    /**
+     * @brief Set f_cost of the point in the current search
+     * @param  {pi} a_star_index : index of the cell (see A_star::_index)
      * @param  {f_cost} std::uint32_t : cost of the point (f_cost = g_cost + h_cost)
      */
-    void _setfcost(std::uint32_t px, std::uint32_t py, std::uint16_t f_cost);
+    void _setfcost(a_star_index pi, a_star_cost f_cost);
 
     /**
-     * @brief Set g_cost of the point in the map
-     * @param  {px} std::uint32_t : X coordinate of the point
-     * @param  {py} std::uint32_t : Y coordinate of the point
+     * @brief Set g_cost of the point in the current search
+     * @param  {pi} a_star_index : index of the cell (see A_star::_index)
      * @param  {g_cost} std::uint32_t : g_cost of the point
      */
-    void _setgcost(std::uint32_t px, std::uint32_t py, std::uint16_t g_cost);
+    void _setgcost(a_star_index pi, a_star_cost g_cost);
 
     /**
      * @brief Returns true if the node is blocked, false otherwise
-     * @param  {xs} std::uint32_t : X coordinate of the point
-     * @param  {ys} std::uint32_t : Y coordinate of the point
+     * @param  {pi} a_star_index : index of the cell (see A_star::_index)
      */
-    bool _isblocked(std::uint32_t px, std::uint32_t py);
+    bool _isblocked(a_star_index pi) const;
 
     /***** Min binary heap definitions *****/
 
     /**
      * Sink down a node
-     * @param {pi} std::uint32_t : index of the point in the list
+     * @param {pi} a_star_index : index of the point in the list
      */
-    void _sink(std::uint32_t pi);
-    void _sink_cl(std::uint32_t pi);
+    void _sink(a_star_index pi);
 
     /**
      * Swim up a node
-     * @param {pi} std::uint32_t : index of the point in the list
+     * @param {pi} a_star_index : index of the point in the list
      */
-    void _swim(std::uint32_t pi);
-    void _swim_cl(std::uint32_t pi);
+    void _swim(a_star_index pi);
 
     /**
      * Add a node
@@ -170,27 +986,242 @@ private:
      * @param {py} std::uint32_t : Y position of the point
      */
     void _add(std::uint32_t px, std::uint32_t py);
-    void _add_cl(std::uint32_t px, std::uint32_t py);
 
     /**
      * Remove a node
-     * @param {pi} std::uint32_t : index of the point in the list
+     * @param {pi} a_star_index : index of the point in the list
      * @returns The removed node
      */
-    std::uint32_t _remove(std::uint32_t pi);
-    std::uint32_t _remove_cl(std::uint32_t pi);
+    a_star_index _remove(a_star_index pi);
 
     /**
      * Exchange two elements
-     * @param  {i0} std::uint32_t : index of first element
-     * @param  {i1} std::uint32_t : index of second element
+     * @param  {i0} a_star_index : index of first element
+     * @param  {i1} a_star_index : index of second element
+     */
+    void _exchange(a_star_index i0, a_star_index i1);
+
+    /***** Open list, whatever the backend *****/
+
+    /**
+     * Remove the open node with the lowest f_cost
+     * @returns The index of the cell (see A_star::_index)
+     */
+    a_star_index _pop();
+
+    /**
+     * Restore the order of an open node after its f_cost went down
+     * @param {pi} a_star_index : index of the cell (see A_star::_index)
      */
-    void _exchange(std::uint32_t i0, std::uint32_t i1);
+    void _decrease(a_star_index pi);
+
+    /***** Bucket queue definitions *****/
+
+    /**
+     * Link a cell at the front of the bucket of its f_cost
+     * @param {pi} a_star_index : index of the cell (see A_star::_index)
+     */
+    void _bucket_add(a_star_index pi);
+
+    /**
+     * Unlink an open cell from its bucket
+     * @param {pi} a_star_index : index of the cell (see A_star::_index)
+     */
+    void _bucket_unlink(a_star_index pi);
+
+    /**
+     * Remove a cell from the lowest non-empty bucket
+     * @returns The index of the cell, A_STAR_ERROR_INDEX if the queue is empty
+     */
+    a_star_index _bucket_pop();
+
+    /**
+     * Empty every bucket left over by the previous search
+     */
+    void _bucket_clear();
 
 public:
+    /**
+     * A waypoint of a path
+     */
+    struct point
+    {
+        std::uint32_t x, y;
+    };
+
+    /**
+     * A query of A_star::run_batch
+     */
+    struct query
+    {
+        std::uint32_t sx, sy, tx, ty;
+        point *path;            // Buffer receiving the waypoints, start first (may be null)
+        std::uint32_t capacity; // Number of points the buffer holds
+    };
+
+    /**
+     * Outcome of a query of A_star::run_batch
+     */
+    struct result
+    {
+        std::uint32_t length;   // Path length in points, 0 if there is no path (see A_star::reconstruct)
+        std::uint32_t expanded; // Nodes expanded by the query
+    };
+
+    /**
+     * What a call to A_star::run cost. Open list counters add up both
+     * frontiers of a bidirectional search.
+     */
+    struct stats
+    {
+        std::uint32_t expanded = 0;  // Nodes expanded
+        std::uint32_t pushed = 0;    // Nodes added to the open list
+        std::uint32_t popped = 0;    // Nodes taken from the open list
+        std::uint32_t decreased = 0; // Open nodes reached again at a lower cost
+        a_star_index peak_open = 0;  // Largest size of the open list
+        std::uint64_t search_ns = 0; // Time spent searching
+        std::uint64_t path_ns = 0;   // Time spent writing the path into the caller's buffer
+    };
+
     A_star() {};
     A_star(std::uint32_t xs, std::uint32_t ys);
-    ~A_star() ;
+
+    /**
+     * @brief  Opens a map written by A_star::save. Built with A_STAR_PACKED_GRID
+     *         and row-major (no A_STAR_TILED_GRID), the file is mapped and its
+     *         bitmap is the obstacle layer as is:
+     *         construction takes constant time, a page is only read from disk
+     *         when a search first touches it, and processes opening the same
+     *         file share the pages. toggletile still works, on a private copy
+     *         of the page it changes; the file is never written. Other builds
+     *         copy the bitmap into their own layout while loading.
+     *         If the file cannot be read the planner has no map, like one that
+     *         could not be allocated.
+     * @param  {path} const char* : map file
+     */
+    explicit A_star(const char *path);
+    ~A_star();
+
+    A_star(const A_star &) = delete;
+    A_star &operator=(const A_star &) = delete;
+
+    /**
+     * @brief  Selects the open list backend used by the next searches.
+     *         A_STAR_QUEUE_BUCKET suits maps whose f_costs only take a few
+     *         distinct values per search (open floors), the heap is the safe default.
+     * @param  {queue} std::uint8_t : A_STAR_QUEUE_HEAP or A_STAR_QUEUE_BUCKET
+     * @returns false if the backend is unknown or cannot be allocated
+     */
+    bool set_queue(std::uint8_t queue);
+
+    /**
+     * @brief  Selects how the next searches expand nodes. A_STAR_EXPAND_JPS
+     *         finds paths as short as plain A* while expanding far fewer nodes
+     *         on open maps. Paths still come back cell by cell from A_star::reconstruct.
+     *         A_STAR_EXPAND_JPS_PLUS builds jump tables on first selection
+     *         (32 bytes per cell) and keeps them up to date on every toggletile
+     *         afterwards, which suits maps that rarely change.
+     * @param  {expansion} std::uint8_t : A_STAR_EXPAND_ALL, A_STAR_EXPAND_JPS or A_STAR_EXPAND_JPS_PLUS
+     * @returns false if the strategy is unknown or the tables cannot be allocated
+     */
+    bool set_expansion(std::uint8_t expansion);
+
+    /**
+     * @brief  Selects the heuristic policy of A_star::run, together with the
+     *         move costs it is admissible for (see heuristics.hh). Octile and
+     *         Euclidean costs are 10 per cell, so their paths can only be a
+     *         tenth as long before g_cost overflows. Jump point search needs
+     *         A_STAR_HEURISTIC_CHEBYSHEV; hierarchical, bidirectional and
+     *         incremental searches always use it.
+     * @param  {heuristic} std::uint8_t : one of the A_STAR_HEURISTIC_* policies
+     * @returns false if the policy is unknown or does not fit the expansion strategy
+     */
+    bool set_heuristic(std::uint8_t heuristic);
+
+    /**
+     * @brief  Selects how plain A* looks at the neighbors of an expanded
+     *         node. The kernels gather the state of all 8 neighbors in one
+     *         pass and only visit the ones worth pushing; A_STAR_SIMD_OFF
+     *         checks them one by one. New planners start on A_STAR_SIMD_AUTO.
+     * @param  {level} std::uint8_t : one of the A_STAR_SIMD_* levels
+     * @returns false if the level is unknown or the CPU does not support it
+     */
+    bool set_simd(std::uint8_t level);
+
+    /**
+     * @brief  Builds (or drops, with 0) the HPA* abstraction queried by
+     *         A_star::run_hierarchical. Clusters touched by toggletile are
+     *         only rebuilt, lazily, by the next hierarchical query.
+     * @param  {cluster} std::uint32_t : side of the clusters in cells, up to 255
+     * @returns false if the map is missing or the size is not supported
+     */
+    bool set_hierarchy(std::uint32_t cluster);
+
+    /**
+     * @brief  Searches the abstract graph of A_star::set_hierarchy, then
+     *         refines every hop between entrances with a search inside its
+     *         cluster. Much faster than A_star::run on long queries, paths are
+     *         near-optimal and go through the cluster entrances.
+     * @param  {path} A_star::point* : buffer receiving the waypoints, start first (may be null)
+     * @param  {capacity} std::uint32_t : number of points the buffer holds
+     * @returns The path length in points, 0 if there is no path. Nothing is written
+     *          when it is larger than capacity.
+     */
+    std::uint32_t run_hierarchical(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty,
+                                   point *path, std::uint32_t capacity);
+
+    /**
+     * @brief  Sets the number of threads A_star::run_batch spreads queries
+     *         over, the calling one included. Each extra thread gets its own
+     *         search buffers, as large as the ones of the planner.
+     * @param  {threads} std::uint32_t : number of threads, 0 for one per hardware thread
+     * @returns false if the map is missing or a search context cannot be allocated
+     */
+    bool set_threads(std::uint32_t threads);
+
+    /**
+     * @brief  Runs many queries in parallel on a work-stealing thread pool,
+     *         each like A_star::run with a path buffer and with the current
+     *         queue and expansion settings. The map is shared read only, so
+     *         it must not change (toggletile) while a batch runs.
+     * @param  {queries} const A_star::query* : queries to run
+     * @param  {results} A_star::result* : outcome of every query, same order
+     * @param  {count} std::uint32_t : number of queries
+     */
+    void run_batch(const query *queries, result *results, std::uint32_t count);
+
+    /**
+     * @brief  Makes A_star::run search from both ends at once. It stops as
+     *         soon as no path through the unexpanded nodes can beat the best
+     *         meeting found, so paths stay optimal. That test only bounds
+     *         the unexpanded paths by the f_cost of each frontier alone: on
+     *         maps of long corridors and walls to go around (mazes) the
+     *         frontiers meet early but must both grow past the path cost
+     *         before they stop, and expand more nodes than A_star::run does.
+     *         Bidirectional searches always expand all 8 neighbors, whatever
+     *         set_expansion says, and A_star::run_batch keeps its workers
+     *         unidirectional.
+     * @param  {mode} std::uint8_t : A_STAR_BIDIR_OFF, A_STAR_BIDIR_ALTERNATE or A_STAR_BIDIR_THREADS
+     * @returns false if the mode is unknown or its buffers cannot be allocated
+     */
+    bool set_bidirectional(std::uint8_t mode);
+
+    /**
+     * @brief  Labels the connected components of the map (or drops the labels,
+     *         with false), so that A_star::run and A_star::run_batch turn down
+     *         a query whose start and target cannot be joined at once instead
+     *         of flooding the start's component. The labels are built in
+     *         parallel, on the batch threads (see set_threads) or one thread per
+     *         hardware thread, then kept up to date by toggletile: freeing a
+     *         cell costs a few unions, blocking one a search of the pieces it
+     *         may cut off, walked in step so the smallest bounds the cost.
+     *         When that piece is a large part of the map (cutting a maze),
+     *         the next query labels the map afresh instead.
+     *         One a_star_index per cell.
+     * @param  {enabled} bool : build the labels, or drop them
+     * @returns false if the map is missing or the labels cannot be allocated
+     */
+    bool set_components(bool enabled);
 
     /**
      * @brief  Sets tile state (A_STAR_BLOCKED/A_STAR_UNBLOCKED)
@@ -200,20 +1231,121 @@ public:
     void toggletile(std::uint32_t px, std::uint32_t py, bool tile_state);
 
     /**
-     * @brief  Performs A* calculation and populates A_star::px and A_star::py.
+     * @brief  Returns true if the tile is blocked (or out of the map)
+     * @param  {px} std::uint32_t : X Position of the tile
+     * @param  {py} std::uint32_t : Y Position of the tile
+     */
+    bool blocked(std::uint32_t px, std::uint32_t py);
+
+    /**
+     * @brief  Writes the obstacle layer to a binary map file: a 64 byte header
+     *         (A_STAR_FILE_MAGIC, A_STAR_FILE_VERSION, resolution and row
+     *         stride) then one bit per cell, set for blocked cells, exactly the
+     *         bitmap of a row-major A_STAR_PACKED_GRID build. Terrain costs are not saved.
+     * @param  {path} const char* : file to create or overwrite
+     * @returns false if there is no map or the file cannot be written
+     */
+    bool save(const char *path);
+
+    /**
+     * @brief  Sets the terrain cost of a tile, the factor applied to the price
+     *         of every move entering it: a diagonal move onto a tile of cost 3
+     *         costs three diagonal moves. Costs never go below 1, so the
+     *         heuristics stay admissible. The cost plane (1 byte per cell) is
+     *         only allocated by the first cost other than 1; until then
+     *         searches run exactly as on a uniform map.
+     *         Only plain A* prices moves this way. A_star::run falls back to
+     *         it from jump point and bidirectional search on a map with costs,
+     *         while A_star::run_hierarchical and A_star::run_incremental
+     *         ignore them.
+     * @param  {px} std::uint32_t : X Position of the tile
+     * @param  {py} std::uint32_t : Y Position of the tile
+     * @param  {cost} std::uint8_t : cost from 1 (ordinary floor) to 255
+     * @returns false if the tile is out of the map, the cost is 0 or the plane cannot be allocated
+     */
+    bool set_cost(std::uint32_t px, std::uint32_t py, std::uint8_t cost);
+
+    /**
+     * @brief  Terrain cost of a tile (see A_star::set_cost), 0 out of the map
+     * @param  {px} std::uint32_t : X Position of the tile
+     * @param  {py} std::uint32_t : Y Position of the tile
+     */
+    std::uint8_t cost(std::uint32_t px, std::uint32_t py);
+
+    /**
+     * @brief  Performs A* calculation, leaving parent links for A_star::reconstruct.
      * @param  {sx} std::uint32_t : start X position
      * @param  {sy} std::uint32_t : start Y position
      * @param  {tx} std::uint32_t : target X position
      * @param  {ty} std::uint32_t : target Y position
+     * @returns true if the target was reached
+     */
+    bool run(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty);
+
+    /**
+     * @brief  Performs A* calculation and writes the path into the caller's buffer
+     * @param  {path} A_star::point* : buffer receiving the waypoints, start first
+     * @param  {capacity} std::uint32_t : number of points the buffer holds
+     * @returns The path length (see A_star::reconstruct), 0 if there is no path
      */
-    void run(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty);
+    std::uint32_t run(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty,
+                      point *path, std::uint32_t capacity);
 
     /**
-     * @brief  Reconstructs the path after calculation
+     * @brief  Reconstructs the path of the last calculation up to a reached cell.
+     *         Each parent link is followed backwards until an expanded cell,
+     *         which also walks the straight segments between jump points.
+     *         Nothing is allocated: the waypoints, start and target included, are
+     *         written from the start into the caller's buffer if they fit.
      * @param  {tx} std::uint32_t : target X position
      * @param  {ty} std::uint32_t : target Y position
+     * @param  {path} A_star::point* : buffer receiving the waypoints (may be null)
+     * @param  {capacity} std::uint32_t : number of points the buffer holds
+     * @returns The path length in points, 0 if the cell was not reached. Nothing is
+     *          written when it is larger than capacity, so it can be used to size the buffer.
+     */
+    std::uint32_t reconstruct(std::uint32_t tx, std::uint32_t ty, point *path, std::uint32_t capacity);
+
+    /**
+     * @brief  Plans with D* Lite, which keeps its search between calls: while
+     *         the target stays the same, a call only repairs what changed since
+     *         the previous one, the start having moved and cells having been
+     *         toggled. Paths are as short as those of A_star::run; the first
+     *         call, and any call with a new target, costs a full search.
+     *         A_star::reconstruct keeps referring to the last A_star::run.
+     * @param  {path} A_star::point* : buffer receiving the waypoints, start first (may be null)
+     * @param  {capacity} std::uint32_t : number of points the buffer holds
+     * @returns The path length in points, 0 if there is no path. Nothing is written
+     *          when it is larger than capacity.
+     */
+    std::uint32_t run_incremental(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty,
+                                  point *path, std::uint32_t capacity);
+
+    /**
+     * @brief  Number of nodes expanded by the last call to A_star::run or
+     *         A_star::run_incremental, or of abstract nodes by the last call
+     *         to A_star::run_hierarchical
+     */
+    std::uint32_t expanded() const { return this->ne; }
+
+    /**
+     * @brief  Statistics of the last call to A_star::run (see A_STAR_STATS)
+     */
+    const stats &last_stats() const { return this->st; }
+
+private:
+    stats st; // Statistics of the last run, filled through A_STAR_STAT
+
+    /**
+     * @brief  A_star::reconstruct for the cells reached by this planner's own search
+     */
+    std::uint32_t _reconstruct(std::uint32_t tx, std::uint32_t ty, point *path, std::uint32_t capacity);
+
+    /**
+     * @brief Joins the forward path to the meeting cell with the backward one
+     *        from it, see A_star::reconstruct
      */
-    void reconstruct(std::uint32_t tx, std::uint32_t ty);
+    std::uint32_t _reconstruct_bidir(point *path, std::uint32_t capacity);
 };
 
 #endif
\ No newline at end of file
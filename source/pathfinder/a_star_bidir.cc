@@ -0,0 +1,240 @@
+#include "a_star.hh"
+#include "ioutils.hh"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+/**
+ * Bidirectional A*: a forward search from the start towards the target and
+ * a backward one from the target towards the start, moves being symmetric.
+ * A cell closed by both frontiers gives a path of cost g_forward + g_backward.
+ * The f_cost a frontier pops never goes down (consistent heuristic), so it
+ * bounds every path through the nodes that frontier has not expanded yet;
+ * once the larger of both bounds reaches the best path found, no other
+ * path can be shorter. Start cells count as closed at cost 0 from the
+ * beginning, so a frontier closing the other's start is a meeting too.
+ * On two threads the rule leans on one ordering: a frontier records the
+ * meetings of an expansion in best before it publishes the f_cost of its
+ * next pop with a release store, and the other frontier reads that f_cost
+ * with an acquire load before it reads best. A bound read from the other
+ * frontier therefore comes with every path found before it was published.
+ */
+
+// State shared by both frontiers of a bidirectional search
+struct bidir_args
+{
+    A_star *side[2];                    // Forward planner, backward context
+    std::uint32_t goal_x[2], goal_y[2]; // Cell each frontier heads to
+    std::atomic<std::uint64_t> best;    // Cost of the best path found, all ones while there is none
+    a_star_index meet;                  // Meeting cell of that path
+    std::mutex lock;                    // Held to improve best and meet together
+    std::atomic<std::uint32_t> fmin[2]; // f_cost last popped by each frontier
+    std::atomic<bool> stop;             // Set by the first frontier that is done
+};
+
+bool A_star::set_bidirectional(std::uint8_t mode)
+{
+    if (mode != A_STAR_BIDIR_OFF && mode != A_STAR_BIDIR_ALTERNATE && mode != A_STAR_BIDIR_THREADS)
+    {
+        cout_err("set_bidirectional", "unknown bidirectional mode");
+        return false;
+    }
+
+    if (mode != A_STAR_BIDIR_OFF)
+    {
+        // A context borrowing the map of another planner cannot lend it further
+        if (!_check_map() || !this->mo)
+            return false;
+
+        if (this->dw == nullptr)
+        {
+            this->dw.reset(new A_star(this));
+            if (this->dw->map == nullptr)
+            {
+                cout_err("set_bidirectional", "could not allocate the backward search");
+                this->dw.reset();
+                return false;
+            }
+        }
+
+        if (this->dt == nullptr)
+        {
+            std::size_t cells = 2 * _cells();
+            void *raw = mem.alloc(cells * sizeof(std::atomic<std::uint64_t>));
+            if (raw == nullptr)
+            {
+                cout_err("set_bidirectional", "could not allocate the meeting table");
+                return false;
+            }
+
+            this->dt = static_cast<std::atomic<std::uint64_t> *>(raw);
+            for (std::size_t i = 0; i < cells; i++)
+                new (this->dt + i) std::atomic<std::uint64_t>(0);
+            this->dg = 0;
+        }
+
+        if (mode == A_STAR_BIDIR_THREADS && this->dp == nullptr)
+            this->dp.reset(new work_pool(2));
+    }
+
+    this->dm = mode;
+    return true;
+}
+
+a_star_cost A_star::_meet(a_star_index pi, std::uint32_t side, a_star_cost gcost)
+{
+    std::atomic<std::uint64_t> *slot = this->dt + 2 * std::size_t(pi);
+
+    // Sequentially consistent: of two frontiers closing the same cell at once, at least one sees the other
+    slot[side].store((std::uint64_t(this->dg) << 32) | gcost);
+    std::uint64_t other = slot[1 - side].load();
+
+    // An entry stamped by an older query holds nothing for this one
+    return (other >> 32) == this->dg ? static_cast<a_star_cost>(other) : A_STAR_ERROR_COST;
+}
+
+bool A_star::_run_bidir(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty)
+{
+    // Plain A* never steps onto a blocked target, the backward search would start there
+    if (_isblocked(_index(tx, ty)))
+    {
+        this->ne = 0;
+        return false;
+    }
+
+    // The backward context follows the queue and kernel settings of the planner
+    if (this->dw->qk != this->qk)
+        this->dw->set_queue(this->qk);
+    this->dw->sk = this->sk;
+    this->dw->sf = this->sf;
+
+    if (++this->dg == 0)
+    {
+        std::size_t cells = 2 * _cells();
+        for (std::size_t i = 0; i < cells; i++)
+            this->dt[i].store(0, std::memory_order_relaxed);
+        this->dg = 1;
+    }
+
+    _begin(sx, sy);
+    this->dw->_begin(tx, ty);
+    A_STAR_STAT(this->dw->st = stats());
+
+    bidir_args args;
+    args.side[0] = this;
+    args.side[1] = this->dw.get();
+    args.goal_x[0] = tx;
+    args.goal_y[0] = ty;
+    args.goal_x[1] = sx;
+    args.goal_y[1] = sy;
+    args.best.store(~std::uint64_t(0));
+    args.meet = A_STAR_ERROR_INDEX;
+    args.fmin[0].store(0);
+    args.fmin[1].store(0);
+    args.stop.store(false);
+
+    a_star_index si = _index(sx, sy), ti = _index(tx, ty);
+    _meet(si, 0, 0);
+    if (_meet(ti, 1, 0) != A_STAR_ERROR_COST)
+    {
+        args.best.store(0);
+        args.meet = ti;
+    }
+
+    if (this->dm == A_STAR_BIDIR_THREADS)
+        this->dp->run(2, &A_star::_bidir_side, &args);
+    else
+    {
+        // The frontier with fewer open nodes goes next, keeping both about the same size
+        while (_bidir_step(&args, this->dw->pl < this->pl ? 1 : 0))
+            ;
+    }
+
+    this->ne += this->dw->ne;
+    A_STAR_STAT(this->st.pushed += this->dw->st.pushed, this->st.popped += this->dw->st.popped,
+                this->st.decreased += this->dw->st.decreased, this->st.peak_open += this->dw->st.peak_open);
+
+    if (args.best.load() == ~std::uint64_t(0))
+        return false;
+
+    this->dc = args.meet;
+    return true;
+}
+
+void A_star::_bidir_side(void *arg, std::uint32_t worker, std::uint32_t index)
+{
+    (void)worker;
+    while (_bidir_step(arg, index))
+        ;
+}
+
+bool A_star::_bidir_step(void *arg, std::uint32_t side)
+{
+    bidir_args *b = static_cast<bidir_args *>(arg);
+    A_star *p = b->side[side];
+
+    if (b->stop.load(std::memory_order_relaxed))
+        return false;
+
+    // An exhausted frontier has closed its whole component, the other's start included
+    if (p->pl == 0)
+    {
+        b->stop.store(true, std::memory_order_relaxed);
+        return false;
+    }
+
+    a_star_index pi = p->_pop();
+    a_star_cost fcost = p->_getfcost(pi), gcost = p->_getgcost(pi);
+    b->fmin[side].store(fcost, std::memory_order_release);
+
+    // The other frontier's bound first, acquired with the paths it found before it; a lagging bound only delays the stop
+    std::uint32_t bound = std::max<std::uint32_t>(fcost, b->fmin[1 - side].load(std::memory_order_acquire));
+    if (bound >= b->best.load(std::memory_order_acquire))
+    {
+        b->stop.store(true, std::memory_order_relaxed);
+        return false;
+    }
+
+    p->ne++;
+    p->_expand(p->_column(pi), p->_row(pi), b->goal_x[side], b->goal_y[side], gcost);
+    p->_setclosed(pi);
+
+    a_star_cost other = b->side[0]->_meet(pi, side, gcost);
+    if (other != A_STAR_ERROR_COST)
+    {
+        // Meetings are rare next to expansions, a lock keeps the cost and the cell of a path together
+        std::uint64_t found = std::uint64_t(gcost) + other;
+        if (found < b->best.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> guard(b->lock);
+            if (found < b->best.load(std::memory_order_relaxed))
+            {
+                b->meet = pi;
+                b->best.store(found, std::memory_order_release);
+            }
+        }
+    }
+
+    return true;
+}
+
+std::uint32_t A_star::_reconstruct_bidir(point *path, std::uint32_t capacity)
+{
+    std::uint32_t mx = _column(this->dc), my = _row(this->dc);
+    std::uint32_t forward = _reconstruct(mx, my, nullptr, 0);
+    std::uint32_t backward = this->dw->_reconstruct(mx, my, nullptr, 0);
+    if (forward == 0 || backward == 0)
+        return 0;
+
+    std::uint32_t length = forward + backward - 1;
+    if (path == nullptr || length > capacity)
+        return length;
+
+    _reconstruct(mx, my, path, capacity);
+
+    // The backward part comes target first, written over the meeting cell and turned around
+    this->dw->_reconstruct(mx, my, path + forward - 1, capacity - forward + 1);
+    std::reverse(path + forward - 1, path + length);
+    return length;
+}
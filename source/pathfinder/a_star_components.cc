@@ -0,0 +1,408 @@
+#include "a_star.hh"
+#include "ioutils.hh"
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+/**
+ * Connected component labels. The map is cut into bands of A_STAR_CC_BAND
+ * rows; each band is labelled on its own with a union-find forest over its
+ * cells, then the bands are joined along their borders and every component
+ * gets a dense label. Moves cut corners, so a free cell touches all 8 free
+ * neighbors, and the neighbors of a cell are connected around it when they
+ * follow each other on its ring or are two orthogonal neighbors apart.
+ */
+
+// State shared by the phases of A_star::_cc_build
+struct cc_args
+{
+    A_star *planner;
+    std::uint32_t phase;
+    std::vector<a_star_index> parent; // Union-find forest over cells, then the label of every root
+    std::vector<a_star_index> roots;  // Roots counted in every band, then the first label of every band
+};
+
+// Root of a cell, halving the path on the way
+static a_star_index cc_root(std::vector<a_star_index> &parent, a_star_index pi)
+{
+    while (parent[pi] != pi)
+    {
+        parent[pi] = parent[parent[pi]];
+        pi = parent[pi];
+    }
+    return pi;
+}
+
+// Joins two trees, the lower root staying root
+static void cc_link(std::vector<a_star_index> &parent, a_star_index a, a_star_index b)
+{
+    a = cc_root(parent, a);
+    b = cc_root(parent, b);
+    if (a != b)
+        parent[std::max(a, b)] = std::min(a, b);
+}
+
+bool A_star::set_components(bool enabled)
+{
+    if (!enabled)
+    {
+        this->ce = false;
+        this->cs = false;
+        this->cp.reset();
+        std::vector<a_star_index>().swap(this->cu);
+        std::vector<std::uint8_t>().swap(this->cr);
+        for (std::vector<a_star_index> &queue : this->cq)
+            std::vector<a_star_index>().swap(queue);
+        std::vector<a_star_index>().swap(this->ch);
+        std::vector<std::uint8_t>().swap(this->co);
+        std::vector<std::size_t>().swap(this->ct);
+        return true;
+    }
+
+    // A context borrowing the map of another planner would miss its toggles
+    if (!_check_map() || !this->mo)
+        return false;
+
+    this->ce = _cc_build();
+    this->cs = false;
+    return this->ce;
+}
+
+bool A_star::_cc_build()
+{
+    std::size_t cells = _cells();
+    if (this->cc == nullptr)
+    {
+        this->cc = static_cast<a_star_index *>(mem.alloc(cells * sizeof(a_star_index)));
+        if (this->cc == nullptr)
+        {
+            cout_err("set_components", "could not allocate the component labels");
+            return false;
+        }
+    }
+    std::fill_n(this->cc, cells, A_STAR_ERROR_INDEX);
+
+    std::uint32_t bands = (this->ys + A_STAR_CC_BAND - 1) / A_STAR_CC_BAND;
+    cc_args args;
+    args.planner = this;
+    args.parent.resize(cells);
+    args.roots.assign(bands, 0);
+
+    // The batch threads are idle between batches, without them a pool of its own is kept for the next labelling
+    work_pool *pool = this->tp.get();
+    if (pool == nullptr)
+    {
+        if (this->cp == nullptr)
+            this->cp.reset(new work_pool(std::max(1u, std::thread::hardware_concurrency())));
+        pool = this->cp.get();
+    }
+
+    args.phase = 0;
+    pool->run(bands, &A_star::_cc_band, &args);
+
+    // Bands only joined cells of their own rows, the first row of each band meets the last of the one above here
+    for (std::uint32_t y = A_STAR_CC_BAND; y < this->ys; y += A_STAR_CC_BAND)
+        for (std::uint32_t x = 0; x < this->xs; x++)
+        {
+            a_star_index pi = _index(x, y);
+            if (_isblocked(pi))
+                continue;
+
+            for (std::int32_t dx = -1; dx <= 1; dx++)
+                if (_isfree(x + dx, y - 1))
+                    cc_link(args.parent, pi, _index(x + dx, y - 1));
+        }
+
+    args.phase = 1;
+    pool->run(bands, &A_star::_cc_band, &args);
+
+    a_star_index labels = 0;
+    for (a_star_index &first : args.roots)
+    {
+        a_star_index count = first;
+        first = labels;
+        labels += count;
+    }
+
+    args.phase = 2;
+    pool->run(bands, &A_star::_cc_band, &args);
+    args.phase = 3;
+    pool->run(bands, &A_star::_cc_band, &args);
+
+    this->cu.resize(labels);
+    std::iota(this->cu.begin(), this->cu.end(), a_star_index(0));
+    this->cr.assign(labels, 0);
+    return true;
+}
+
+void A_star::_cc_band(void *arg, std::uint32_t worker, std::uint32_t index)
+{
+    (void)worker;
+    cc_args *c = static_cast<cc_args *>(arg);
+    A_star *p = c->planner;
+    std::uint32_t y0 = index * A_STAR_CC_BAND, y1 = std::min(y0 + A_STAR_CC_BAND, p->ys);
+
+    for (std::uint32_t y = y0; y < y1; y++)
+        for (std::uint32_t x = 0; x < p->xs; x++)
+        {
+            a_star_index pi = p->_index(x, y);
+            if (p->_isblocked(pi))
+                continue;
+
+            switch (c->phase)
+            {
+            case 0:
+            {
+                /**
+                 * Joined to the free neighbors already visited in the band.
+                 * The north cell touches the other three, and the west and
+                 * north-west cells touch each other, so one or two links do.
+                 */
+                c->parent[pi] = pi;
+                bool north = y > y0 && p->_isfree(x, y - 1);
+                if (north)
+                {
+                    cc_link(c->parent, pi, p->_index(x, y - 1));
+                    break;
+                }
+                if (y > y0 && p->_isfree(x + 1, y - 1))
+                    cc_link(c->parent, pi, p->_index(x + 1, y - 1));
+                if (p->_isfree(x - 1, y))
+                    cc_link(c->parent, pi, p->_index(x - 1, y));
+                else if (y > y0 && p->_isfree(x - 1, y - 1))
+                    cc_link(c->parent, pi, p->_index(x - 1, y - 1));
+                break;
+            }
+            case 1:
+            {
+                // Read only, other bands walk through these cells at the same time
+                a_star_index root = pi;
+                while (c->parent[root] != root)
+                    root = c->parent[root];
+                p->cc[pi] = root;
+                if (root == pi)
+                    c->roots[index]++;
+                break;
+            }
+            case 2:
+                if (p->cc[pi] == pi)
+                    c->parent[pi] = c->roots[index]++;
+                break;
+            default:
+                p->cc[pi] = c->parent[p->cc[pi]];
+                break;
+            }
+        }
+}
+
+a_star_index A_star::_cc_union(a_star_index a, a_star_index b)
+{
+    a = _cc_find(a);
+    b = _cc_find(b);
+    if (a == b)
+        return a;
+
+    if (this->cr[a] < this->cr[b])
+        std::swap(a, b);
+    if (this->cr[a] == this->cr[b])
+        this->cr[a]++;
+    this->cu[b] = a;
+    return a;
+}
+
+bool A_star::_cc_claim(a_star_index ci, std::uint32_t walk, std::uint32_t &owner)
+{
+    const std::size_t mask = this->ch.size() - 1;
+    std::size_t h = static_cast<std::size_t>((std::uint64_t(ci) * UINT64_C(0x9E3779B97F4A7C15)) >> 32) & mask;
+    for (; this->ch[h] != A_STAR_ERROR_INDEX; h = (h + 1) & mask)
+    {
+        if (this->ch[h] == ci)
+        {
+            owner = this->co[h];
+            return false;
+        }
+    }
+
+    this->ch[h] = ci;
+    this->co[h] = static_cast<std::uint8_t>(walk);
+    this->ct.push_back(h);
+    return true;
+}
+
+bool A_star::_reachable(a_star_index si, a_star_index ti) const
+{
+    if (!this->ce || this->cs || _isblocked(si))
+        return true;
+    if (this->cc[ti] == A_STAR_ERROR_INDEX)
+        return false;
+    return _cc_find(this->cc[si]) == _cc_find(this->cc[ti]);
+}
+
+void A_star::_cc_update(std::uint32_t px, std::uint32_t py)
+{
+    // Out of date labels are labelled afresh anyway; splits add a label each, past one per cell that is due too
+    if (this->cs || this->cu.size() >= _cells())
+    {
+        this->cs = true;
+        return;
+    }
+
+    // Neighbors on the ring around the cell, north first and clockwise
+    const std::int32_t rx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+    const std::int32_t ry[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    a_star_index ring[8];
+    for (std::uint32_t i = 0; i < 8; i++)
+        ring[i] = _isfree(px + rx[i], py + ry[i]) ? _index(px + rx[i], py + ry[i]) : A_STAR_ERROR_INDEX;
+
+    a_star_index pi = _index(px, py);
+    if (!_isblocked(pi))
+    {
+        // A freed cell joins every component around it, or starts its own
+        a_star_index label = A_STAR_ERROR_INDEX;
+        for (a_star_index ni : ring)
+        {
+            if (ni != A_STAR_ERROR_INDEX)
+                label = label == A_STAR_ERROR_INDEX ? _cc_find(this->cc[ni]) : _cc_union(label, this->cc[ni]);
+        }
+
+        if (label == A_STAR_ERROR_INDEX)
+        {
+            label = static_cast<a_star_index>(this->cu.size());
+            this->cu.push_back(label);
+            this->cr.push_back(0);
+        }
+        this->cc[pi] = label;
+        return;
+    }
+
+    this->cc[pi] = A_STAR_ERROR_INDEX;
+
+    // Groups of free neighbors still joined around the cell, only separate groups may have been cut apart
+    std::uint32_t group[8];
+    for (std::uint32_t i = 0; i < 8; i++)
+        group[i] = i;
+    for (std::uint32_t i = 0; i < 8; i++)
+    {
+        for (std::uint32_t j : {i + 1, i % 2 == 0 ? i + 2 : i + 1})
+        {
+            std::uint32_t a = group[i], b = group[j % 8];
+            if (ring[i] == A_STAR_ERROR_INDEX || ring[j % 8] == A_STAR_ERROR_INDEX || a == b)
+                continue;
+            for (std::uint32_t &g : group)
+                if (g == b)
+                    g = a;
+        }
+    }
+
+    std::uint32_t count = 0;
+    for (std::uint32_t i = 0; i < 8; i++)
+        if (ring[i] != A_STAR_ERROR_INDEX && group[i] == i)
+        {
+            this->cq[count].clear();
+            this->cq[count++].push_back(ring[i]);
+        }
+    if (count < 2)
+        return;
+
+    /**
+     * One breadth first walk from every group, a cell at a time each in
+     * turn. Walks that meet are joined in a set; a set whose walks all run
+     * out has covered a whole component and gets a new label. The last set
+     * standing keeps the old one, so the walking stops with it. Cutting a
+     * tree shaped component (a maze) may walk a large part of the map. A
+     * walked cell costs some fifty times a labelled one, so past 1/256 of
+     * the map the labels are left for the next query to rebuild instead.
+     */
+    const std::size_t budget = std::max<std::size_t>(_cells() / 256, 1024);
+
+    // The walked cells table stays under half full, its slots are cleared one by one when the walks end
+    std::size_t slots = 64;
+    while (slots < 2 * (budget + 8))
+        slots <<= 1;
+    if (this->ch.size() != slots)
+    {
+        this->ch.assign(slots, A_STAR_ERROR_INDEX);
+        this->co.resize(slots);
+    }
+    auto release = [this]()
+    {
+        for (std::size_t h : this->ct)
+            this->ch[h] = A_STAR_ERROR_INDEX;
+        this->ct.clear();
+    };
+
+    std::uint32_t set[8], head[8] = {0}, owner;
+    for (std::uint32_t w = 0; w < count; w++)
+    {
+        set[w] = w;
+        _cc_claim(this->cq[w][0], w, owner);
+    }
+
+    auto find = [&set](std::uint32_t w)
+    {
+        while (set[w] != w)
+            w = set[w];
+        return w;
+    };
+
+    std::uint32_t live = count;
+    while (live > 1)
+    {
+        for (std::uint32_t w = 0; w < count && live > 1; w++)
+        {
+            std::vector<a_star_index> &cells = this->cq[w];
+            if (head[w] == cells.size())
+                continue;
+
+            a_star_index ci = cells[head[w]++];
+            std::uint32_t x = _column(ci), y = _row(ci);
+            for (std::uint8_t dir = 0; dir < 8; dir++)
+            {
+                std::uint32_t nx = x + dir_x[dir], ny = y + dir_y[dir];
+                if (!_isfree(nx, ny))
+                    continue;
+
+                a_star_index ni = _index(nx, ny);
+                if (_cc_claim(ni, w, owner))
+                {
+                    cells.push_back(ni);
+                    if (this->ct.size() > budget)
+                    {
+                        release();
+                        this->cs = true;
+                        return;
+                    }
+                }
+                else if (find(owner) != find(w))
+                {
+                    set[find(owner)] = find(w);
+                    live--;
+                }
+            }
+
+            if (head[w] < cells.size())
+                continue;
+
+            std::uint32_t root = find(w);
+            bool done = true;
+            for (std::uint32_t v = 0; v < count; v++)
+                done = done && (find(v) != root || head[v] == this->cq[v].size());
+            if (!done)
+                continue;
+
+            a_star_index label = static_cast<a_star_index>(this->cu.size());
+            this->cu.push_back(label);
+            this->cr.push_back(0);
+            for (std::uint32_t v = 0; v < count; v++)
+            {
+                if (find(v) != root)
+                    continue;
+                for (a_star_index vi : this->cq[v])
+                    this->cc[vi] = label;
+            }
+            live--;
+        }
+    }
+    release();
+}
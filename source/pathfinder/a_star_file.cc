@@ -0,0 +1,207 @@
+#include "a_star.hh"
+#include "ioutils.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define A_STAR_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Binary map files, version 1, in the byte order of the machine that wrote
+ * them (little endian on every platform we build for). The header below is
+ * followed, from byte header_size on, by the obstacle bitmap: bit (pi % 64)
+ * of 64 bit word pi / 64 is set when the cell pi = y * stride + x is blocked.
+ * The stride padding of every row is free. Readers reject a version they do
+ * not know, and skip whatever a longer header adds at its end.
+ */
+struct map_header
+{
+    char magic[8];               // A_STAR_FILE_MAGIC, without the terminating zero
+    std::uint32_t version;       // A_STAR_FILE_VERSION
+    std::uint32_t header_size;   // Offset of the bitmap, a multiple of A_STAR_ALIGNMENT
+    std::uint32_t xs, ys;        // Map resolution
+    std::uint32_t stride;        // Cells per row, padding included
+    std::uint32_t reserved;      // 0
+    std::uint64_t payload_bytes; // Size of the bitmap, 8 * ceil(stride * ys / 64)
+    std::uint8_t unused[24];     // 0, pads the header to A_STAR_ALIGNMENT
+};
+
+static_assert(sizeof(map_header) == A_STAR_ALIGNMENT, "the bitmap must start aligned");
+
+a_star_index A_star::_cell(std::size_t pi) const
+{
+#if A_STAR_TILED_GRID
+    return _index(static_cast<std::uint32_t>(pi % this->stride), static_cast<std::uint32_t>(pi / this->stride));
+#else
+    return static_cast<a_star_index>(pi);
+#endif
+}
+
+bool A_star::save(const char *path)
+{
+    if (!_check_map())
+        return false;
+
+    std::size_t cells = static_cast<std::size_t>(this->stride) * this->ys;
+    std::size_t words = (cells + 63) / 64;
+
+    map_header header = {};
+    std::memcpy(header.magic, A_STAR_FILE_MAGIC, sizeof(header.magic));
+    header.version = A_STAR_FILE_VERSION;
+    header.header_size = sizeof(map_header);
+    header.xs = this->xs;
+    header.ys = this->ys;
+    header.stride = this->stride;
+    header.payload_bytes = words * sizeof(std::uint64_t);
+
+    std::FILE *file = std::fopen(path, "wb");
+    if (file == nullptr)
+    {
+        cout_err("save", "could not open the map file");
+        return false;
+    }
+
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+#if A_STAR_PACKED_GRID && !A_STAR_TILED_GRID
+    written = written && std::fwrite(this->map, sizeof(std::uint64_t), words, file) == words;
+#else
+    // Packed (row-major, whatever the layout of this build) a chunk of words at a time
+    std::vector<std::uint64_t> chunk(4096);
+    for (std::size_t w = 0; written && w < words; w += chunk.size())
+    {
+        std::size_t n = std::min(chunk.size(), words - w);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            std::uint64_t bits = 0;
+            std::size_t first = (w + i) * 64, last = std::min(first + 64, cells);
+            for (std::size_t pi = first; pi < last; pi++)
+                bits |= std::uint64_t(_isblocked(_cell(pi))) << (pi - first);
+            chunk[i] = bits;
+        }
+        written = std::fwrite(chunk.data(), sizeof(std::uint64_t), n, file) == n;
+    }
+#endif
+
+    if (std::fclose(file) != 0 || !written)
+    {
+        cout_err("save", "could not write the map file");
+        return false;
+    }
+    return true;
+}
+
+bool A_star::_loadfile(const char *path)
+{
+#if defined(A_STAR_FILE_MMAP)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        cout_err("_loadfile", "could not open the map file");
+        return false;
+    }
+
+    struct stat info;
+    void *base = MAP_FAILED;
+    std::size_t length = 0;
+    if (fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(map_header)))
+    {
+        length = static_cast<std::size_t>(info.st_size);
+        // Private and writable: toggletile copies the page it changes, the file stays as it is
+        base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping keeps the file alive on its own
+    close(fd);
+
+    if (base == MAP_FAILED)
+    {
+        cout_err("_loadfile", "could not map the map file");
+        return false;
+    }
+
+    const map_header *header = static_cast<const map_header *>(base);
+    // Two 32 bit factors, the product fits 64 bits whatever size_t is
+    std::uint64_t cells = std::uint64_t(header->stride) * header->ys;
+    std::uint64_t words = (cells + 63) / 64;
+    std::uint32_t stride = 0;
+
+    const char *error = nullptr;
+    if (std::memcmp(header->magic, A_STAR_FILE_MAGIC, sizeof(header->magic)) != 0)
+        error = "not a map file";
+    else if (header->version != A_STAR_FILE_VERSION)
+        error = "unsupported map file version";
+    else if (header->header_size < sizeof(map_header) || header->header_size % A_STAR_ALIGNMENT != 0)
+        error = "bad map file header size";
+    else if (header->xs == 0 || header->ys == 0 || !_layout(header->xs, header->ys, stride) || header->stride != stride)
+        error = "bad map file resolution";
+    else if (words > SIZE_MAX / sizeof(std::uint64_t))
+        error = "map file too large";
+    else if (header->payload_bytes != words * sizeof(std::uint64_t) || header->header_size > length ||
+             length - header->header_size < header->payload_bytes)
+        error = "truncated map file";
+
+    if (error != nullptr)
+    {
+        cout_err("_loadfile", error);
+        munmap(base, length);
+        return false;
+    }
+
+    const std::uint64_t *bits = reinterpret_cast<const std::uint64_t *>(static_cast<const char *>(base) + header->header_size);
+    this->xs = header->xs;
+    this->ys = header->ys;
+
+#if A_STAR_PACKED_GRID && !A_STAR_TILED_GRID
+    // The bitmap is the map, the search buffers are lazily committed too
+    this->stride = header->stride;
+    this->map = const_cast<std::uint64_t *>(bits);
+    this->mf = base;
+    this->mz = length;
+    this->mo = true;
+    _loadsearch();
+#else
+    _loadmap();
+    if (this->map != nullptr)
+    {
+        // Only blocked cells are written, the map starts free; bits past the last row are ignored
+        for (std::size_t w = 0; w < words; w++)
+            for (std::uint64_t word = bits[w]; word != 0; word &= word - 1)
+            {
+                std::size_t pi = w * 64 + __builtin_ctzll(word);
+                if (pi >= cells)
+                    break;
+
+                a_star_index ci = _cell(pi);
+#if A_STAR_PACKED_GRID
+                this->map[ci >> 6] |= std::uint64_t(1) << (ci & 63);
+#else
+                this->map[ci] = A_STAR_NODE_BLOCKED;
+#endif
+            }
+    }
+    munmap(base, length);
+#endif
+
+    return this->map != nullptr;
+#else
+    (void)path;
+    cout_err("_loadfile", "map files need mmap");
+    return false;
+#endif
+}
+
+void A_star::_closefile()
+{
+#if defined(A_STAR_FILE_MMAP)
+    munmap(this->mf, this->mz);
+#endif
+    this->mf = nullptr;
+    this->mz = 0;
+}
@@ -0,0 +1,377 @@
+#include "a_star.hh"
+#include "ioutils.hh"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+/**
+ * Hierarchical path-finding A* (Botea, Müller & Schaeffer, 2004), one level.
+ * Entrances follow the free runs along each cluster border, plus the
+ * diagonal moves that cross a border or a corner with both cells beside
+ * them blocked, so every move between clusters goes through an entrance.
+ * Intra-cluster distances come from a breadth first search, moves all
+ * costing 1 and cutting corners as in A_star::run.
+ */
+
+bool A_star::set_hierarchy(std::uint32_t cluster)
+{
+    if (cluster == 0)
+    {
+        this->hc = 0;
+        std::vector<hpa_cluster>().swap(this->hk);
+        std::vector<std::uint32_t>().swap(this->hq);
+        return true;
+    }
+
+    if (!_check_map())
+        return false;
+
+    // Distances inside a cluster must fit the 16 bit entries of A_star::kd
+    if (cluster > 255)
+    {
+        cout_err("set_hierarchy", "clusters are at most 255 cells wide");
+        return false;
+    }
+
+    this->hc = cluster;
+    this->hw = (this->xs + cluster - 1) / cluster;
+    this->hh = (this->ys + cluster - 1) / cluster;
+    this->hk.assign(std::size_t(this->hw) * this->hh, hpa_cluster());
+    this->hq.resize(this->hk.size());
+    for (std::uint32_t k = 0; k < this->hq.size(); k++)
+        this->hq[k] = k;
+
+    this->kd.resize(cluster * cluster);
+    this->kp.resize(cluster * cluster);
+    this->kq.resize(cluster * cluster);
+
+    _hpa_refresh();
+    return true;
+}
+
+void A_star::_hpa_refresh()
+{
+    for (std::uint32_t k : this->hq)
+        _hpa_build(k);
+    this->hq.clear();
+
+    this->ho.resize(this->hk.size() + 1);
+    this->ho[0] = 0;
+    for (std::size_t k = 0; k < this->hk.size(); k++)
+        this->ho[k + 1] = this->ho[k] + static_cast<std::uint32_t>(this->hk[k].cell.size());
+
+    // Node numbers move, but stamps of former queries never match a new one
+    std::size_t nodes = this->ho.back() + 2;
+    this->hs.resize(nodes, 0);
+    this->hg.resize(nodes);
+    this->hr.resize(nodes);
+    this->hx.resize(nodes);
+    this->hy.resize(nodes);
+    for (std::uint32_t k = 0; k < this->hk.size(); k++)
+        for (std::uint32_t j = 0; j < this->hk[k].cell.size(); j++)
+        {
+            this->hx[this->ho[k] + j] = this->hk[k].cell[j];
+            this->hy[this->ho[k] + j] = k;
+        }
+}
+
+void A_star::_hpa_build(std::uint32_t k)
+{
+    hpa_cluster &c = this->hk[k];
+    c.cell.clear();
+    c.peer.clear();
+
+    std::uint32_t x0 = k % this->hw * this->hc, y0 = k / this->hw * this->hc;
+    std::uint32_t w = std::min(this->hc, this->xs - x0), h = std::min(this->hc, this->ys - y0);
+
+    if (x0 > 0)
+        _hpa_border(k, x0 - 1, y0, true, h, true);
+    if (x0 + w < this->xs)
+        _hpa_border(k, x0 + w - 1, y0, true, h, false);
+    if (y0 > 0)
+        _hpa_border(k, x0, y0 - 1, false, w, true);
+    if (y0 + h < this->ys)
+        _hpa_border(k, x0, y0 + h - 1, false, w, false);
+
+    // Corners towards the diagonal neighbors, other moves out of a corner cross a border
+    const std::uint32_t cx[4] = {x0, x0 + w - 1, x0, x0 + w - 1};
+    const std::uint32_t cy[4] = {y0, y0, y0 + h - 1, y0 + h - 1};
+    const std::int32_t dx[4] = {-1, 1, -1, 1};
+    const std::int32_t dy[4] = {-1, -1, 1, 1};
+    for (int i = 0; i < 4; i++)
+    {
+        std::uint32_t nx = cx[i] + dx[i], ny = cy[i] + dy[i];
+        if (_isfree(cx[i], cy[i]) && _isfree(nx, ny) && !_isfree(nx, cy[i]) && !_isfree(cx[i], ny))
+        {
+            c.cell.push_back(_index(cx[i], cy[i]));
+            c.peer.push_back(_index(nx, ny));
+        }
+    }
+
+    std::size_t n = c.cell.size();
+    c.dist.assign(n * n, A_STAR_ERROR_16);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        _hpa_bfs(k, c.cell[i]);
+        for (std::size_t j = 0; j < n; j++)
+            c.dist[i * n + j] = this->kd[_hpa_local(c.cell[j])];
+    }
+
+    c.dirty = false;
+}
+
+void A_star::_hpa_border(std::uint32_t k, std::uint32_t x, std::uint32_t y, bool vertical, std::uint32_t length, bool high)
+{
+    hpa_cluster &c = this->hk[k];
+
+    // Steps along the border, and from the low side to the high side
+    const std::uint32_t ax = vertical ? 0 : 1, ay = vertical ? 1 : 0;
+    const std::uint32_t cx = vertical ? 1 : 0, cy = vertical ? 0 : 1;
+
+    // Entrance from the cell li of the low side to the cell hi of the high side
+    auto entrance = [&](std::uint32_t li, std::uint32_t hi)
+    {
+        a_star_index low = _index(x + li * ax, y + li * ay);
+        a_star_index up = _index(x + hi * ax + cx, y + hi * ay + cy);
+        c.cell.push_back(high ? up : low);
+        c.peer.push_back(high ? low : up);
+    };
+
+    std::uint32_t run = 0;
+    for (std::uint32_t i = 0; i <= length; i++)
+    {
+        std::uint32_t lx = x + i * ax, ly = y + i * ay;
+        bool low = i < length && _isfree(lx, ly);
+        bool up = i < length && _isfree(lx + cx, ly + cy);
+        if (low && up)
+        {
+            run++;
+            continue;
+        }
+
+        if (run > 0)
+        {
+            std::uint32_t first = i - run;
+            if (run < A_STAR_ENTRANCE_SPLIT)
+                entrance(first + run / 2, first + run / 2);
+            else
+            {
+                entrance(first, first);
+                entrance(i - 1, i - 1);
+            }
+            run = 0;
+        }
+
+        // A diagonal move across the border between two blocked cells
+        if (i + 1 < length)
+        {
+            bool low_next = _isfree(lx + ax, ly + ay);
+            bool up_next = _isfree(lx + ax + cx, ly + ay + cy);
+            if (low && !up && up_next && !low_next)
+                entrance(i, i + 1);
+            if (!low && up && low_next && !up_next)
+                entrance(i + 1, i);
+        }
+    }
+}
+
+void A_star::_hpa_bfs(std::uint32_t k, a_star_index pi)
+{
+    std::uint32_t x0 = k % this->hw * this->hc, y0 = k / this->hw * this->hc;
+    std::uint32_t w = std::min(this->hc, this->xs - x0), h = std::min(this->hc, this->ys - y0);
+
+    std::fill(this->kd.begin(), this->kd.end(), A_STAR_ERROR_16);
+
+    // The queue holds cluster coordinates, (y << 8) | x, clusters being at most 255 cells wide
+    std::uint32_t head = 0, tail = 0;
+    std::uint32_t sl = _hpa_local(pi);
+    this->kd[sl] = 0;
+    this->kp[sl] = A_STAR_DIR_NONE;
+    this->kq[tail++] = (sl / this->hc) << 8 | (sl % this->hc);
+
+    while (head < tail)
+    {
+        std::uint32_t x = this->kq[head] & 0xFF, y = this->kq[head] >> 8;
+        std::uint16_t d = this->kd[y * this->hc + x];
+        head++;
+
+        for (std::uint8_t dir = 0; dir < 8; dir++)
+        {
+            // Cells left of or above the cluster wrap around to huge offsets
+            std::uint32_t nx = x + dir_x[dir], ny = y + dir_y[dir];
+            if (nx >= w || ny >= h)
+                continue;
+
+            std::uint32_t nl = ny * this->hc + nx;
+            if (this->kd[nl] != A_STAR_ERROR_16 || _isblocked(_index(x0 + nx, y0 + ny)))
+                continue;
+
+            this->kd[nl] = d + 1;
+            this->kp[nl] = dir;
+            this->kq[tail++] = ny << 8 | nx;
+        }
+    }
+}
+
+bool A_star::_hpa_relax(std::uint32_t node, std::uint32_t g, std::uint32_t parent)
+{
+    if (this->hs[node] == this->hn && this->hg[node] <= g)
+        return false;
+
+    this->hs[node] = this->hn;
+    this->hg[node] = g;
+    this->hr[node] = parent;
+    return true;
+}
+
+std::uint32_t A_star::run_hierarchical(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty,
+                                       point *path, std::uint32_t capacity)
+{
+    if (!_check_map() || !_check_coords(sx, sy) || !_check_coords(tx, ty))
+        return 0;
+
+    if (this->hc == 0)
+    {
+        cout_err("run_hierarchical", "no hierarchy, see set_hierarchy");
+        return 0;
+    }
+
+    a_star_index si = _index(sx, sy), ti = _index(tx, ty);
+    if (_isblocked(si) || _isblocked(ti))
+        return 0;
+
+    if (!this->hq.empty())
+        _hpa_refresh();
+
+    this->ne = 0;
+    if (++this->hn == 0)
+    {
+        std::fill(this->hs.begin(), this->hs.end(), 0);
+        this->hn = 1;
+    }
+
+    const std::uint32_t start = this->ho.back(), target = start + 1;
+    const std::uint32_t ks = _hpa_of(sx, sy), kt = _hpa_of(tx, ty);
+
+    this->hx[start] = si;
+    this->hx[target] = ti;
+    auto heuristic = [&](std::uint32_t node)
+    {
+        a_star_index pi = this->hx[node];
+        return _distance(_column(pi), _row(pi), tx, ty);
+    };
+
+    typedef std::pair<std::uint32_t, std::uint32_t> entry; // f_cost, node
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+
+    // The target is linked to the nodes of its cluster, the start to the nodes of its own
+    const hpa_cluster &ct = this->hk[kt];
+    _hpa_bfs(kt, ti);
+    this->ht.resize(ct.cell.size());
+    for (std::size_t j = 0; j < ct.cell.size(); j++)
+        this->ht[j] = this->kd[_hpa_local(ct.cell[j])];
+
+    _hpa_bfs(ks, si);
+    _hpa_relax(start, 0, start);
+    if (ks == kt && this->kd[_hpa_local(ti)] != A_STAR_ERROR_16)
+    {
+        _hpa_relax(target, this->kd[_hpa_local(ti)], start);
+        open.push({this->hg[target], target});
+    }
+    for (std::size_t j = 0; j < this->hk[ks].cell.size(); j++)
+    {
+        std::uint16_t d = this->kd[_hpa_local(this->hk[ks].cell[j])];
+        std::uint32_t node = this->ho[ks] + static_cast<std::uint32_t>(j);
+        if (d != A_STAR_ERROR_16 && _hpa_relax(node, d, start))
+            open.push({d + heuristic(node), node});
+    }
+
+    while (!open.empty())
+    {
+        entry top = open.top();
+        open.pop();
+
+        std::uint32_t u = top.second;
+        if (u == target)
+            break;
+        // Nodes are pushed again when their cost goes down, older entries are skipped
+        if (top.first != this->hg[u] + heuristic(u))
+            continue;
+
+        this->ne++;
+        std::uint32_t k = this->hy[u], i = u - this->ho[k], g = this->hg[u];
+        const hpa_cluster &c = this->hk[k];
+        std::size_t n = c.cell.size();
+
+        if (k == kt && this->ht[i] != A_STAR_ERROR_16 && _hpa_relax(target, g + this->ht[i], u))
+            open.push({this->hg[target], target});
+
+        for (std::size_t j = 0; j < n; j++)
+        {
+            std::uint16_t d = c.dist[i * n + j];
+            std::uint32_t node = this->ho[k] + static_cast<std::uint32_t>(j);
+            if (j != i && d != A_STAR_ERROR_16 && _hpa_relax(node, g + d, u))
+                open.push({g + d + heuristic(node), node});
+        }
+
+        // The peer is the entrance of the other cluster pointing back at this one
+        a_star_index p = c.peer[i];
+        std::uint32_t kn = _hpa_of(_column(p), _row(p));
+        const hpa_cluster &cp = this->hk[kn];
+        for (std::size_t j = 0; j < cp.cell.size(); j++)
+        {
+            if (cp.cell[j] != p || cp.peer[j] != c.cell[i])
+                continue;
+
+            std::uint32_t node = this->ho[kn] + static_cast<std::uint32_t>(j);
+            if (_hpa_relax(node, g + 1, u))
+                open.push({g + 1 + heuristic(node), node});
+            break;
+        }
+    }
+
+    if (this->hs[target] != this->hn)
+        return 0;
+
+    std::uint32_t length = this->hg[target] + 1;
+    if (path == nullptr || length > capacity)
+        return length;
+
+    this->ha.clear();
+    for (std::uint32_t node = target; node != start; node = this->hr[node])
+        this->ha.push_back(node);
+
+    // Hops inside a cluster are searched again, hops across a border are a single move
+    std::uint32_t pos = 0;
+    a_star_index prev = si;
+    path[0] = {sx, sy};
+    for (std::size_t h = this->ha.size(); h-- > 0;)
+    {
+        a_star_index pi = this->hx[this->ha[h]];
+        std::uint32_t x = _column(pi), y = _row(pi);
+        if (pi == prev)
+            continue;
+
+        std::uint32_t k = _hpa_of(x, y);
+        if (k != _hpa_of(_column(prev), _row(prev)))
+            path[++pos] = {x, y};
+        else
+        {
+            _hpa_bfs(k, prev);
+            std::uint16_t d = this->kd[_hpa_local(pi)];
+            for (std::uint32_t s = d; s > 0; s--)
+            {
+                path[pos + s] = {x, y};
+                std::uint8_t dir = this->kp[_hpa_local(_index(x, y))];
+                x -= dir_x[dir];
+                y -= dir_y[dir];
+            }
+            pos += d;
+        }
+        prev = pi;
+    }
+
+    return length;
+}
@@ -0,0 +1,290 @@
+#include "a_star.hh"
+#include "ioutils.hh"
+
+#include <algorithm>
+
+/**
+ * Jump Point Search (Harabor & Grastien, 2011) on the same map as plain A*.
+ * Diagonal moves are allowed past blocked corners, as in A_star::run.
+ * Moves all cost 1, so a jump costs the number of cells it crosses.
+ *
+ * JPS+ (Harabor & Grastien, 2014) precomputes, for every cell and direction,
+ * what A_star::_jump would find ignoring the target. Straight entries of a
+ * cell only depend on its row or column, diagonal ones on the next cell of
+ * its diagonal, so a changed cell only needs its three rows and columns
+ * swept again. Diagonal entries are then walked back from every cell whose
+ * inputs changed, for as long as they keep changing.
+ */
+
+bool A_star::_forced(std::uint32_t x, std::uint32_t y, std::int32_t dx, std::int32_t dy)
+{
+    // A wall behind one side opens a diagonal that only this cell reaches optimally
+    if (dx != 0 && dy != 0)
+        return (!_isfree(x - dx, y) && _isfree(x - dx, y + dy)) ||
+               (!_isfree(x, y - dy) && _isfree(x + dx, y - dy));
+    if (dx != 0)
+        return (!_isfree(x, y + 1) && _isfree(x + dx, y + 1)) ||
+               (!_isfree(x, y - 1) && _isfree(x + dx, y - 1));
+    return (!_isfree(x + 1, y) && _isfree(x + 1, y + dy)) ||
+           (!_isfree(x - 1, y) && _isfree(x - 1, y + dy));
+}
+
+bool A_star::_jump(std::uint32_t &x, std::uint32_t &y, std::uint8_t dir, std::uint32_t tx, std::uint32_t ty)
+{
+    const std::int32_t dx = dir_x[dir];
+    const std::int32_t dy = dir_y[dir];
+
+    for (;;)
+    {
+        x += dx;
+        y += dy;
+
+        if (!_isfree(x, y))
+            return false;
+
+        if (x == tx && y == ty)
+            return true;
+
+        if (_forced(x, y, dx, dy))
+            return true;
+
+        if (dx != 0 && dy != 0)
+        {
+            // A diagonal cell is a jump point if either straight jump from it finds one
+            std::uint32_t sx = x, sy = y;
+            if (_jump(sx, sy, dx > 0 ? A_STAR_DIR_E : A_STAR_DIR_W, tx, ty))
+                return true;
+
+            sx = x;
+            sy = y;
+            if (_jump(sx, sy, dy > 0 ? A_STAR_DIR_S : A_STAR_DIR_N, tx, ty))
+                return true;
+        }
+    }
+}
+
+bool A_star::_jump_table(std::uint32_t &x, std::uint32_t &y, std::uint8_t dir, std::uint32_t tx, std::uint32_t ty)
+{
+    const std::int32_t dx = dir_x[dir];
+    const std::int32_t dy = dir_y[dir];
+    const std::int32_t jump = this->jt[std::size_t(_index(x, y)) * 8 + dir];
+    const std::int64_t reach = jump > 0 ? jump : -jump;
+
+    // Steps towards the target on each axis, only positive if it lies ahead
+    std::int64_t ax = (std::int64_t(tx) - x) * dx;
+    std::int64_t ay = (std::int64_t(ty) - y) * dy;
+
+    if (dx != 0 && dy != 0)
+    {
+        // The diagonal cell sharing a row or column with the target is where a straight jump would find it
+        std::int64_t k = std::min(ax, ay);
+        if (k > 0 && k <= reach)
+        {
+            x += std::int32_t(k) * dx;
+            y += std::int32_t(k) * dy;
+            return true;
+        }
+    }
+    else if ((dx != 0 && ty == y && ax > 0 && ax <= reach) || (dy != 0 && tx == x && ay > 0 && ay <= reach))
+    {
+        x = tx;
+        y = ty;
+        return true;
+    }
+
+    if (jump <= 0)
+        return false;
+
+    x += jump * dx;
+    y += jump * dy;
+    return true;
+}
+
+bool A_star::_jps_build()
+{
+    std::size_t cells = _cells();
+
+    this->jt = static_cast<std::int32_t *>(mem.alloc(cells * 8 * sizeof(std::int32_t)));
+    if (this->jt == nullptr)
+    {
+        cout_err("_jps_build", "could not allocate the jump tables");
+        return false;
+    }
+
+    for (std::uint32_t y = 0; y < this->ys; y++)
+    {
+        _jps_sweep(this->xs - 1, y, A_STAR_DIR_E, this->xs, false);
+        _jps_sweep(0, y, A_STAR_DIR_W, this->xs, false);
+    }
+    for (std::uint32_t x = 0; x < this->xs; x++)
+    {
+        _jps_sweep(x, this->ys - 1, A_STAR_DIR_S, this->ys, false);
+        _jps_sweep(x, 0, A_STAR_DIR_N, this->ys, false);
+    }
+
+    // Diagonal lines x + y = k walked by NE and SW, then x - y = k - (ys - 1) walked by SE and NW
+    const std::int64_t xs = this->xs, ys = this->ys;
+    for (std::int64_t k = 0; k < xs + ys - 1; k++)
+    {
+        std::int64_t x0 = std::max<std::int64_t>(0, k - (ys - 1)), x1 = std::min<std::int64_t>(xs - 1, k);
+        std::uint32_t count = std::uint32_t(x1 - x0 + 1);
+        _jps_sweep(std::uint32_t(x1), std::uint32_t(k - x1), A_STAR_DIR_NE, count, false);
+        _jps_sweep(std::uint32_t(x0), std::uint32_t(k - x0), A_STAR_DIR_SW, count, false);
+
+        std::int64_t d = k - (ys - 1);
+        x0 = std::max<std::int64_t>(0, d);
+        x1 = std::min<std::int64_t>(xs - 1, ys - 1 + d);
+        count = std::uint32_t(x1 - x0 + 1);
+        _jps_sweep(std::uint32_t(x1), std::uint32_t(x1 - d), A_STAR_DIR_SE, count, false);
+        _jps_sweep(std::uint32_t(x0), std::uint32_t(x0 - d), A_STAR_DIR_NW, count, false);
+    }
+
+    return true;
+}
+
+void A_star::_jps_update(std::uint32_t px, std::uint32_t py)
+{
+    // Forced neighbors look one cell to each side, so the rows and columns next to the cell change too
+    for (std::uint32_t y = py > 0 ? py - 1 : 0; y <= py + 1 && y < this->ys; y++)
+    {
+        _jps_sweep(this->xs - 1, y, A_STAR_DIR_E, this->xs, true);
+        _jps_sweep(0, y, A_STAR_DIR_W, this->xs, true);
+    }
+    for (std::uint32_t x = px > 0 ? px - 1 : 0; x <= px + 1 && x < this->xs; x++)
+    {
+        _jps_sweep(x, this->ys - 1, A_STAR_DIR_S, this->ys, true);
+        _jps_sweep(x, 0, A_STAR_DIR_N, this->ys, true);
+    }
+
+    // Diagonal moves stop at the cell itself, and diagonal forced neighbors look one cell around
+    for (std::uint32_t y = py > 0 ? py - 1 : 0; y <= py + 1 && y < this->ys; y++)
+        for (std::uint32_t x = px > 0 ? px - 1 : 0; x <= px + 1 && x < this->xs; x++)
+            _jps_ripple(x, y);
+}
+
+std::int32_t A_star::_jps_entry(std::uint32_t x, std::uint32_t y, std::uint8_t dir)
+{
+    const std::int32_t dx = dir_x[dir];
+    const std::int32_t dy = dir_y[dir];
+    const std::uint32_t nx = x + dx, ny = y + dy;
+
+    if (!_isfree(nx, ny))
+        return 0;
+
+    const std::int32_t *next = this->jt + std::size_t(_index(nx, ny)) * 8;
+    if (_forced(nx, ny, dx, dy))
+        return 1;
+    // A diagonal cell is a jump point if either straight jump from it finds one
+    if (dx != 0 && dy != 0 && (next[dx > 0 ? A_STAR_DIR_E : A_STAR_DIR_W] > 0 || next[dy > 0 ? A_STAR_DIR_S : A_STAR_DIR_N] > 0))
+        return 1;
+    return next[dir] > 0 ? next[dir] + 1 : next[dir] - 1;
+}
+
+void A_star::_jps_sweep(std::uint32_t x, std::uint32_t y, std::uint8_t dir, std::uint32_t count, bool ripple)
+{
+    const std::int32_t dx = dir_x[dir];
+    const std::int32_t dy = dir_y[dir];
+
+    // Walks the line backwards, each entry follows from the one of the next cell
+    for (std::uint32_t i = 0; i < count; i++, x -= dx, y -= dy)
+    {
+        std::int32_t value = _jps_entry(x, y, dir);
+        std::int32_t &entry = this->jt[std::size_t(_index(x, y)) * 8 + dir];
+
+        // Diagonal entries only look at whether the straight ones find a jump point
+        bool flipped = (entry > 0) != (value > 0);
+        entry = value;
+        if (ripple && flipped)
+            _jps_ripple(x, y);
+    }
+}
+
+void A_star::_jps_ripple(std::uint32_t x, std::uint32_t y)
+{
+    for (std::uint8_t dir = A_STAR_DIR_SE; dir <= A_STAR_DIR_SW; dir++)
+    {
+        const std::int32_t dx = dir_x[dir];
+        const std::int32_t dy = dir_y[dir];
+
+        // Stops at the first entry left as it was, the ones before it follow from it
+        for (std::uint32_t cx = x - dx, cy = y - dy; _in_bounds(cx, cy); cx -= dx, cy -= dy)
+        {
+            std::int32_t value = _jps_entry(cx, cy, dir);
+            std::int32_t &entry = this->jt[std::size_t(_index(cx, cy)) * 8 + dir];
+            if (entry == value)
+                break;
+            entry = value;
+        }
+    }
+}
+
+// Direction code of a unit move
+static std::uint8_t _dir_of(std::int32_t dx, std::int32_t dy)
+{
+    if (dy == 0)
+        return dx > 0 ? A_STAR_DIR_E : A_STAR_DIR_W;
+    if (dx == 0)
+        return dy > 0 ? A_STAR_DIR_S : A_STAR_DIR_N;
+    if (dx > 0)
+        return dy > 0 ? A_STAR_DIR_SE : A_STAR_DIR_NE;
+    return dy > 0 ? A_STAR_DIR_SW : A_STAR_DIR_NW;
+}
+
+void A_star::_expand_jps(std::uint32_t x, std::uint32_t y, std::uint32_t tx, std::uint32_t ty, a_star_cost gcost)
+{
+    std::uint8_t parent = this->pd[_index(x, y)];
+    std::uint8_t dirs[8];
+    std::uint8_t count = 0;
+
+    if (parent == A_STAR_DIR_NONE)
+    {
+        // The start has no parent to prune against
+        for (std::uint8_t d = 0; d < 8; d++)
+            dirs[count++] = d;
+    }
+    else
+    {
+        const std::int32_t dx = dir_x[parent];
+        const std::int32_t dy = dir_y[parent];
+
+        if (dx != 0 && dy != 0)
+        {
+            dirs[count++] = _dir_of(dx, 0);
+            dirs[count++] = _dir_of(0, dy);
+            dirs[count++] = parent;
+            if (!_isfree(x - dx, y))
+                dirs[count++] = _dir_of(-dx, dy);
+            if (!_isfree(x, y - dy))
+                dirs[count++] = _dir_of(dx, -dy);
+        }
+        else if (dx != 0)
+        {
+            dirs[count++] = parent;
+            if (!_isfree(x, y + 1))
+                dirs[count++] = _dir_of(dx, 1);
+            if (!_isfree(x, y - 1))
+                dirs[count++] = _dir_of(dx, -1);
+        }
+        else
+        {
+            dirs[count++] = parent;
+            if (!_isfree(x + 1, y))
+                dirs[count++] = _dir_of(1, dy);
+            if (!_isfree(x - 1, y))
+                dirs[count++] = _dir_of(-1, dy);
+        }
+    }
+
+    for (std::uint8_t i = 0; i < count; i++)
+    {
+        std::uint32_t jx = x, jy = y;
+        bool found = this->xk == A_STAR_EXPAND_JPS_PLUS ? _jump_table(jx, jy, dirs[i], tx, ty) : _jump(jx, jy, dirs[i], tx, ty);
+        if (!found)
+            continue;
+
+        // A jump too long for a g_cost is held just past the limit, check_node turns it down
+        a_star_cost step = static_cast<a_star_cost>(std::min<std::uint64_t>(_distance(x, y, jx, jy), A_STAR_GCOST_MAX + 1));
+        if (check_node(jx, jy, tx, ty, gcost, dirs[i], step))
+            _add(jx, jy);
+    }
+}
@@ -0,0 +1,230 @@
+#include "a_star.hh"
+#include "ioutils.hh"
+
+#include <algorithm>
+#include <functional>
+
+/**
+ * D* Lite (Koenig and Likhachev, 2002) in its optimized form. Moves cost 1
+ * and may not enter a blocked cell, so the lookahead of a cell only depends
+ * on the g_cost of its free neighbors: a blocked cell's own g_cost is never
+ * propagated, and toggling a cell only changes the lookahead of the cell
+ * and its 8 neighbors. Blocked cells have no lookahead unless the robot
+ * stands on one, as plain A* may leave a blocked start too.
+ */
+
+bool A_star::_lite_reset(a_star_index si, a_star_index ti)
+{
+    std::size_t cells = _cells();
+    if (this->lg == nullptr)
+    {
+        this->lg = static_cast<std::uint16_t *>(mem.alloc(cells * sizeof(std::uint16_t)));
+        this->lr = static_cast<std::uint16_t *>(mem.alloc(cells * sizeof(std::uint16_t)));
+        if (this->lg == nullptr || this->lr == nullptr)
+        {
+            cout_err("run_incremental", "could not allocate the D* Lite planes");
+            this->lg = nullptr;
+            this->lr = nullptr;
+            return false;
+        }
+    }
+
+    std::fill_n(this->lg, cells, A_STAR_ERROR_16);
+    std::fill_n(this->lr, cells, A_STAR_ERROR_16);
+    this->lq.clear();
+    this->lc.clear();
+    this->lk = 0;
+    this->lt = ti;
+    this->lo = si;
+
+    this->lr[ti] = 0;
+    _lite_queue(ti);
+    return true;
+}
+
+std::uint64_t A_star::_lite_key(a_star_index pi)
+{
+    std::uint32_t gcost = std::min(this->lg[pi], this->lr[pi]);
+    if (gcost == A_STAR_ERROR_16)
+        return ~std::uint64_t(0);
+
+    std::uint32_t h = _distance(_column(pi), _row(pi), _column(this->lo), _row(this->lo));
+    return (std::uint64_t(gcost + h + this->lk) << 16) | gcost;
+}
+
+void A_star::_lite_queue(a_star_index pi)
+{
+    if (this->lg[pi] == this->lr[pi])
+        return;
+
+    this->lq.push_back({_lite_key(pi), pi});
+    std::push_heap(this->lq.begin(), this->lq.end(), std::greater<lite_entry>());
+}
+
+void A_star::_lite_update(a_star_index pi)
+{
+    if (pi != this->lt)
+    {
+        std::uint32_t best = A_STAR_ERROR_16;
+        if (!_isblocked(pi) || pi == this->lo)
+        {
+            std::uint32_t x = _column(pi), y = _row(pi);
+            for (std::uint8_t dir = 0; dir < 8; dir++)
+            {
+                std::uint32_t nx = x + dir_x[dir], ny = y + dir_y[dir];
+                if (_isfree(nx, ny))
+                    best = std::min<std::uint32_t>(best, this->lg[_index(nx, ny)] + 1u);
+            }
+        }
+        this->lr[pi] = static_cast<std::uint16_t>(std::min<std::uint32_t>(best, A_STAR_ERROR_16));
+    }
+
+    _lite_queue(pi);
+}
+
+void A_star::_lite_compute()
+{
+    // Outdated entries only have lower keys than their cell, so the loop can run longer but never stops early
+    while (!this->lq.empty())
+    {
+        lite_entry top = this->lq.front();
+        if (top.first >= _lite_key(this->lo) && this->lg[this->lo] == this->lr[this->lo])
+            break;
+
+        std::pop_heap(this->lq.begin(), this->lq.end(), std::greater<lite_entry>());
+        this->lq.pop_back();
+
+        a_star_index pi = top.second;
+        if (this->lg[pi] == this->lr[pi])
+            continue;
+
+        std::uint64_t key = _lite_key(pi);
+        if (top.first != key)
+        {
+            this->lq.push_back({key, pi});
+            std::push_heap(this->lq.begin(), this->lq.end(), std::greater<lite_entry>());
+            continue;
+        }
+
+        this->ne++;
+        std::uint32_t x = _column(pi), y = _row(pi);
+        bool open = !_isblocked(pi);
+
+        if (this->lg[pi] > this->lr[pi])
+        {
+            // The cell got closer: neighbors may now go through it
+            std::uint32_t gcost = this->lg[pi] = this->lr[pi];
+            if (!open)
+                continue;
+
+            for (std::uint8_t dir = 0; dir < 8; dir++)
+            {
+                std::uint32_t nx = x + dir_x[dir], ny = y + dir_y[dir];
+                if (!_in_bounds(nx, ny))
+                    continue;
+
+                a_star_index ni = _index(nx, ny);
+                if (ni != this->lt && gcost + 1 < this->lr[ni] && (!_isblocked(ni) || ni == this->lo))
+                {
+                    this->lr[ni] = static_cast<std::uint16_t>(gcost + 1);
+                    _lite_queue(ni);
+                }
+            }
+        }
+        else
+        {
+            // The cell got further: neighbors that went through it look again
+            std::uint32_t old = this->lg[pi];
+            this->lg[pi] = A_STAR_ERROR_16;
+            _lite_update(pi);
+            if (!open)
+                continue;
+
+            for (std::uint8_t dir = 0; dir < 8; dir++)
+            {
+                std::uint32_t nx = x + dir_x[dir], ny = y + dir_y[dir];
+                if (!_in_bounds(nx, ny))
+                    continue;
+
+                a_star_index ni = _index(nx, ny);
+                if (ni != this->lt && this->lr[ni] == old + 1)
+                    _lite_update(ni);
+            }
+        }
+    }
+}
+
+std::uint32_t A_star::run_incremental(std::uint32_t sx, std::uint32_t sy, std::uint32_t tx, std::uint32_t ty,
+                                      point *path, std::uint32_t capacity)
+{
+    if (!_check_map() || !_check_coords(sx, sy) || !_check_coords(tx, ty))
+        return 0;
+
+    a_star_index si = _index(sx, sy), ti = _index(tx, ty);
+    this->ne = 0;
+
+    if (this->lg == nullptr || ti != this->lt || this->lk > A_STAR_LITE_KM_MAX)
+    {
+        if (!_lite_reset(si, ti))
+            return 0;
+    }
+    else
+    {
+        if (si != this->lo)
+        {
+            this->lk += _distance(_column(this->lo), _row(this->lo), sx, sy);
+            this->lo = si;
+            _lite_update(si);
+        }
+
+        // A toggled cell changes the cost of every move into it
+        for (a_star_index pi : this->lc)
+        {
+            std::uint32_t x = _column(pi), y = _row(pi);
+            _lite_update(pi);
+            for (std::uint8_t dir = 0; dir < 8; dir++)
+            {
+                std::uint32_t nx = x + dir_x[dir], ny = y + dir_y[dir];
+                if (_in_bounds(nx, ny))
+                    _lite_update(_index(nx, ny));
+            }
+        }
+        this->lc.clear();
+    }
+
+    _lite_compute();
+
+    if (this->lg[si] == A_STAR_ERROR_16)
+        return 0;
+
+    std::uint32_t length = this->lg[si] + 1u;
+    if (path == nullptr || length > capacity)
+        return length;
+
+    // Every step goes down the g_cost by one, through cells the search has settled
+    a_star_index pi = si;
+    for (std::uint32_t i = 0; i < length; i++)
+    {
+        std::uint32_t x = _column(pi), y = _row(pi);
+        path[i] = {x, y};
+        if (pi == ti)
+            break;
+
+        a_star_index next = A_STAR_ERROR_INDEX;
+        for (std::uint8_t dir = 0; dir < 8 && next == A_STAR_ERROR_INDEX; dir++)
+        {
+            std::uint32_t nx = x + dir_x[dir], ny = y + dir_y[dir];
+            if (_isfree(nx, ny) && this->lg[_index(nx, ny)] + 1u == this->lg[pi])
+                next = _index(nx, ny);
+        }
+
+        if (next == A_STAR_ERROR_INDEX)
+        {
+            cout_err("run_incremental", "broken descent while extracting the path");
+            return 0;
+        }
+        pi = next;
+    }
+
+    return length;
+}
@@ -0,0 +1,260 @@
+#include "a_star.hh"
+#include "ioutils.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define A_STAR_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Successor kernels of plain A* expansion. A neighbor is worth pushing when
+ * it is in bounds and free, and either has not been reached by the current
+ * search yet or is still open with a g_cost above the one through the
+ * expanded cell (the heuristic of a cell never changes within a search, so
+ * comparing g_cost is the same as comparing f_cost). Closed cells are never
+ * reopened. The vector kernels are compiled for their instruction set with
+ * target attributes and only called once the CPU is known to support it.
+ */
+
+// Offsets of the A_STAR_DIR_* moves, as 32 bit lanes
+#define A_STAR_SIMD_DX 1, -1, 0, 0, 1, 1, -1, -1
+#define A_STAR_SIMD_DY 0, 0, 1, -1, 1, -1, -1, 1
+
+/**
+ * @brief Three consecutive bits of a bitmap, the west, middle and east cells of a row
+ * @param  {ri} a_star_index : index of the west cell
+ */
+static std::uint32_t row_bits(const std::uint64_t *bits, a_star_index ri)
+{
+    std::uint64_t word = bits[ri >> 6] >> (ri & 63);
+    if ((ri & 63) > 61)
+        word |= bits[(ri >> 6) + 1] << (64 - (ri & 63));
+    return static_cast<std::uint32_t>(word & 7);
+}
+
+/**
+ * @brief Arranges the row_bits of the 3 rows around a cell in A_STAR_DIR_* order
+ */
+static std::uint32_t row_mask(std::uint32_t n, std::uint32_t m, std::uint32_t s)
+{
+    return (m >> 2 & 1) | (m & 1) << 1 | (s >> 1 & 1) << 2 | (n >> 1 & 1) << 3 |
+           (s >> 2 & 1) << 4 | (n >> 2 & 1) << 5 | (n & 1) << 6 | (s & 1) << 7;
+}
+
+static bool simd_supported(std::uint8_t level)
+{
+#if defined(A_STAR_SIMD_X86)
+    if (level == A_STAR_SIMD_AVX2)
+        return __builtin_cpu_supports("avx2");
+    if (level == A_STAR_SIMD_SSE4)
+        return __builtin_cpu_supports("sse4.1");
+#endif
+    return level == A_STAR_SIMD_OFF || level == A_STAR_SIMD_SCALAR;
+}
+
+bool A_star::set_simd(std::uint8_t level)
+{
+    if (level == A_STAR_SIMD_AUTO)
+        level = simd_supported(A_STAR_SIMD_AVX2)   ? A_STAR_SIMD_AVX2
+                : simd_supported(A_STAR_SIMD_SSE4) ? A_STAR_SIMD_SSE4
+                                                   : A_STAR_SIMD_SCALAR;
+
+    if (level > A_STAR_SIMD_AUTO)
+    {
+        cout_err("set_simd", "unknown expansion kernel");
+        return false;
+    }
+
+    if (!simd_supported(level))
+    {
+        cout_err("set_simd", "the CPU does not support this expansion kernel");
+        return false;
+    }
+
+    // The vector kernels handle coordinates as signed 32 bit lanes
+    if (level >= A_STAR_SIMD_SSE4 && (this->stride > 0x7FFFFFFF || this->ys > 0x7FFFFFFF))
+        level = A_STAR_SIMD_SCALAR;
+
+    const successor_kernel kernels[] = {nullptr, &A_star::_successors_scalar, &A_star::_successors_sse4,
+                                        &A_star::_successors_avx2};
+    this->sk = level;
+    this->sf = kernels[level];
+    return true;
+}
+
+std::uint32_t A_star::_successors_scalar(const A_star *planner, a_star_index pi, std::uint32_t x, std::uint32_t y,
+                                         a_star_cost gcost, std::uint16_t straight, std::uint16_t diagonal)
+{
+    (void)pi;
+    std::uint32_t mask = 0;
+    for (std::uint8_t dir = 0; dir < 8; dir++)
+    {
+        std::uint32_t nx = x + dir_x[dir], ny = y + dir_y[dir];
+        if (!planner->_in_bounds(nx, ny))
+            continue;
+
+        a_star_index ni = planner->_index(nx, ny);
+        if (planner->_isblocked(ni))
+            continue;
+
+        if (planner->sg[ni] == planner->gen)
+        {
+            std::uint32_t old_gcost = static_cast<std::uint32_t>((planner->sw[ni] & A_STAR_GCOST_MASK) >> 1);
+            std::uint32_t new_gcost = gcost + (dir < A_STAR_DIR_SE ? straight : diagonal);
+            if (((planner->cl[ni >> 6] >> (ni & 63)) & 1) || old_gcost <= new_gcost)
+                continue;
+        }
+
+        mask |= 1u << dir;
+    }
+    return mask;
+}
+
+#if defined(A_STAR_SIMD_X86)
+
+__attribute__((target("sse4.1"))) std::uint32_t A_star::_successors_sse4(const A_star *planner, a_star_index pi,
+                                                                         std::uint32_t x, std::uint32_t y,
+                                                                         a_star_cost gcost, std::uint16_t straight,
+                                                                         std::uint16_t diagonal)
+{
+    (void)pi;
+    const std::int32_t dx[8] = {A_STAR_SIMD_DX}, dy[8] = {A_STAR_SIMD_DY};
+    const std::uint32_t *cl = reinterpret_cast<const std::uint32_t *>(planner->cl);
+    const __m128i one = _mm_set1_epi32(1), none = _mm_set1_epi32(-1);
+    std::uint32_t mask = 0;
+
+    // SSE has no gather: two halves of 4 neighbors, loaded lane by lane, compared together
+    for (std::uint32_t half = 0; half < 2; half++)
+    {
+        __m128i hx = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dx + 4 * half));
+        __m128i hy = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dy + 4 * half));
+        __m128i nx = _mm_add_epi32(_mm_set1_epi32(static_cast<std::int32_t>(x)), hx);
+        __m128i ny = _mm_add_epi32(_mm_set1_epi32(static_cast<std::int32_t>(y)), hy);
+        __m128i inb = _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(nx, none), _mm_cmpgt_epi32(_mm_set1_epi32(planner->xs), nx)),
+                                    _mm_and_si128(_mm_cmpgt_epi32(ny, none), _mm_cmpgt_epi32(_mm_set1_epi32(planner->ys), ny)));
+        std::uint32_t lanes = static_cast<std::uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(inb)));
+
+        alignas(16) std::uint32_t cells[4] = {0}, stamps[4] = {0}, words[4] = {0}, closed[4] = {0};
+        for (std::uint32_t i = 0; i < 4; i++)
+        {
+            if (!(lanes >> i & 1))
+                continue;
+
+            a_star_index ni = planner->_index(x + dx[4 * half + i], y + dy[4 * half + i]);
+            cells[i] = planner->_isblocked(ni) ? 0 : 1;
+            stamps[i] = planner->sg[ni];
+            words[i] = static_cast<std::uint32_t>(planner->sw[ni]); // g_cost is in the low half of wide words too
+            closed[i] = cl[ni >> 5] >> (ni & 31);
+        }
+
+        __m128i free = _mm_and_si128(inb, _mm_cmpeq_epi32(_mm_and_si128(_mm_load_si128(reinterpret_cast<const __m128i *>(cells)), one), one));
+        __m128i cur = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(stamps)), _mm_set1_epi32(static_cast<std::int32_t>(planner->gen)));
+        __m128i shut = _mm_cmpeq_epi32(_mm_and_si128(_mm_load_si128(reinterpret_cast<const __m128i *>(closed)), one), one);
+        __m128i old_gcost = _mm_and_si128(_mm_srli_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(words)), 1), _mm_set1_epi32(static_cast<std::int32_t>(A_STAR_GCOST_MAX)));
+        __m128i new_gcost = _mm_set1_epi32(gcost + (half == 0 ? straight : diagonal));
+
+        __m128i better = _mm_andnot_si128(shut, _mm_cmpgt_epi32(old_gcost, new_gcost));
+        __m128i pick = _mm_and_si128(free, _mm_or_si128(_mm_andnot_si128(cur, none), better));
+        mask |= static_cast<std::uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(pick))) << (4 * half);
+    }
+    return mask;
+}
+
+/**
+ * @brief Arranges the 3 rows around a cell in A_STAR_DIR_* lane order: the
+ *        rows north and south are joined in one register and permuted, then
+ *        the east and west lanes are blended in from the middle row
+ * @param  {n} __m128i : north row, west cell in lane 0, the middle and south rows likewise
+ */
+__attribute__((target("avx2"))) static __m256i avx2_arrange(__m128i n, __m128i m, __m128i s)
+{
+    const __m256i order = _mm256_setr_epi32(0, 0, 5, 1, 6, 2, 0, 4), sides = _mm256_setr_epi32(2, 0, 0, 0, 0, 0, 0, 0);
+    __m256i ns = _mm256_permutevar8x32_epi32(_mm256_set_m128i(s, n), order);
+    __m256i ew = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(m), sides);
+    return _mm256_blend_epi32(ns, ew, 0b00000011);
+}
+
+/**
+ * @brief Loads a plane around a cell into A_STAR_DIR_* lane order, one unaligned load per row
+ * @param  {north} a_star_index : index of the north-west neighbor, the middle and south rows likewise
+ */
+__attribute__((target("avx2"))) static __m256i avx2_neighbors(const std::uint32_t *plane, a_star_index north,
+                                                              a_star_index middle, a_star_index south)
+{
+    return avx2_arrange(_mm_loadu_si128(reinterpret_cast<const __m128i *>(plane + north)),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(plane + middle)),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(plane + south)));
+}
+
+#if A_STAR_COST_BITS > 16
+
+/**
+ * @brief Same for a plane of 64 bit cells, keeping the low half of each:
+ *        a row is 4 cells in one 256 bit load, packed into 128 bits first
+ */
+__attribute__((target("avx2"))) static __m256i avx2_neighbors(const std::uint64_t *plane, a_star_index north,
+                                                              a_star_index middle, a_star_index south)
+{
+    const __m256i low = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    __m128i n = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(plane + north)), low));
+    __m128i m = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(plane + middle)), low));
+    __m128i s = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(plane + south)), low));
+    return avx2_arrange(n, m, s);
+}
+
+#endif
+
+__attribute__((target("avx2"))) std::uint32_t A_star::_successors_avx2(const A_star *planner, a_star_index pi,
+                                                                       std::uint32_t x, std::uint32_t y,
+                                                                       a_star_cost gcost, std::uint16_t straight,
+                                                                       std::uint16_t diagonal)
+{
+    // Border cells have neighbors out of bounds, and the row loads below read one cell past the east neighbor
+    if (x == 0 || y == 0 || x + 1 >= planner->xs || y + 1 >= planner->ys || x + 2 >= planner->stride)
+        return _successors_scalar(planner, pi, x, y, gcost, straight, diagonal);
+
+    // The neighbors are 3 cells in each of 3 rows: one unaligned load per row and plane instead of a gather
+#if A_STAR_TILED_GRID
+    // Rows are only contiguous inside a tile, the 4 cells a load reads must share one
+    if ((x & (A_STAR_TILE - 1)) - 1 > A_STAR_TILE - 4)
+        return _successors_scalar(planner, pi, x, y, gcost, straight, diagonal);
+    const a_star_index north = planner->_index(x - 1, y - 1), middle = pi - 1, south = planner->_index(x - 1, y + 1);
+#else
+    const a_star_index north = pi - planner->stride - 1, middle = pi - 1, south = pi + planner->stride - 1;
+#endif
+
+#if A_STAR_PACKED_GRID
+    std::uint32_t free = ~row_mask(row_bits(planner->map, north), row_bits(planner->map, middle), row_bits(planner->map, south)) & 0xFF;
+#else
+    const __m256i one = _mm256_set1_epi32(1);
+    std::uint32_t free = static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(
+        _mm256_cmpeq_epi32(_mm256_and_si256(avx2_neighbors(planner->map, north, middle, south), one), one))));
+#endif
+    __m256i cur = _mm256_cmpeq_epi32(avx2_neighbors(planner->sg, north, middle, south), _mm256_set1_epi32(static_cast<std::int32_t>(planner->gen)));
+    __m256i old_gcost = _mm256_and_si256(_mm256_srli_epi32(avx2_neighbors(planner->sw, north, middle, south), 1), _mm256_set1_epi32(static_cast<std::int32_t>(A_STAR_GCOST_MAX)));
+    __m256i new_gcost = _mm256_add_epi32(_mm256_set1_epi32(gcost), _mm256_setr_epi32(straight, straight, straight, straight,
+                                                                                    diagonal, diagonal, diagonal, diagonal));
+    __m256i better = _mm256_and_si256(cur, _mm256_cmpgt_epi32(old_gcost, new_gcost));
+
+    std::uint32_t closed = row_mask(row_bits(planner->cl, north), row_bits(planner->cl, middle), row_bits(planner->cl, south));
+    std::uint32_t seen = static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(cur)));
+    std::uint32_t cheaper = static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(better)));
+    return free & (~seen | (cheaper & ~closed)) & 0xFF;
+}
+
+#else
+
+// Never selected without x86 support (see simd_supported)
+std::uint32_t A_star::_successors_sse4(const A_star *planner, a_star_index pi, std::uint32_t x, std::uint32_t y,
+                                       a_star_cost gcost, std::uint16_t straight, std::uint16_t diagonal)
+{
+    return _successors_scalar(planner, pi, x, y, gcost, straight, diagonal);
+}
+
+std::uint32_t A_star::_successors_avx2(const A_star *planner, a_star_index pi, std::uint32_t x, std::uint32_t y,
+                                       a_star_cost gcost, std::uint16_t straight, std::uint16_t diagonal)
+{
+    return _successors_scalar(planner, pi, x, y, gcost, straight, diagonal);
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include "arena.hh"
+#include "ioutils.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ARENA_MMAP
+#include <sys/mman.h>
+#endif
+
+std::atomic<std::uint64_t> arena::na{0};
+
+arena::~arena()
+{
+    while (this->head != nullptr)
+    {
+        block *prev = this->head->prev;
+#if defined(ARENA_MMAP)
+        if (this->head->mapped)
+            munmap(this->head, header + this->head->size);
+        else
+#endif
+            std::free(this->head);
+        this->head = prev;
+    }
+}
+
+bool arena::_grow(std::size_t bytes)
+{
+    std::size_t size = bytes;
+    if (this->head != nullptr)
+        size = std::max(size, 2 * this->head->size);
+
+    size = (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+
+    block *b = nullptr;
+    bool mapped = false;
+#if defined(ARENA_MMAP)
+    if (header + size >= ARENA_MAP_THRESHOLD)
+    {
+        // Fresh anonymous pages read as zero and take no memory until written
+        void *pages = mmap(nullptr, header + size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (pages != MAP_FAILED)
+        {
+            b = static_cast<block *>(pages);
+            mapped = true;
+        }
+    }
+#endif
+
+    if (b == nullptr)
+    {
+        b = static_cast<block *>(std::aligned_alloc(ARENA_ALIGNMENT, header + size));
+        if (b == nullptr)
+        {
+            cout_err("arena::_grow", "out of memory");
+            return false;
+        }
+        std::memset(b, 0, header + size);
+    }
+
+    na.fetch_add(1, std::memory_order_relaxed);
+
+    b->prev = this->head;
+    b->size = size;
+    b->used = 0;
+    b->mapped = mapped;
+    this->head = b;
+    return true;
+}
+
+bool arena::reserve(std::size_t bytes)
+{
+    if (this->head != nullptr && this->head->size - this->head->used >= bytes)
+        return true;
+    return _grow(bytes);
+}
+
+void *arena::alloc(std::size_t bytes, std::size_t align)
+{
+    if (this->head != nullptr)
+    {
+        std::size_t offset = (this->head->used + align - 1) & ~(align - 1);
+        if (offset + bytes <= this->head->size)
+        {
+            this->head->used = offset + bytes;
+            return reinterpret_cast<char *>(this->head) + header + offset;
+        }
+    }
+
+    if (!_grow(bytes))
+        return nullptr;
+
+    this->head->used = bytes;
+    return reinterpret_cast<char *>(this->head) + header;
+}
+
+std::size_t arena::capacity() const
+{
+    std::size_t total = 0;
+    for (block *b = this->head; b != nullptr; b = b->prev)
+        total += b->size;
+    return total;
+}
@@ -0,0 +1,86 @@
+/**
+ * @brief Planner-owned memory arena for the search buffers
+ */
+#ifndef ARENA_ROBALGOR
+#define ARENA_ROBALGOR
+
+// Alignment (in bytes) of every block and, by default, of every allocation
+#define ARENA_ALIGNMENT 64
+
+// Blocks of at least this many bytes are anonymous mappings (POSIX systems)
+#define ARENA_MAP_THRESHOLD (std::size_t(1) << 20)
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bump allocator made of a chain of blocks. Memory is handed out linearly
+ * and only given back to the system when the arena is destroyed, so buffers
+ * carved out of it can be reused by every query without touching the heap.
+ * When a request does not fit, a new block at least twice the size of the
+ * previous one is added.
+ *
+ * Memory is always handed out zero-filled. Large blocks are mapped straight
+ * from the system, which only backs a page with memory once it is written:
+ * a buffer sized to a huge map costs what the searches actually touch.
+ */
+class arena
+{
+private:
+    struct block
+    {
+        block *prev;      // Previously allocated block
+        std::size_t size; // Usable bytes after the header
+        std::size_t used; // Bytes handed out
+        bool mapped;      // Anonymous mapping, given back with munmap
+    };
+
+    // Block headers are padded so the data behind them stays aligned
+    static constexpr std::size_t header = (sizeof(block) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+
+    block *head = nullptr; // Block allocations are served from
+
+    static std::atomic<std::uint64_t> na; // Blocks obtained from the system by all arenas
+
+    /**
+     * @brief  Adds a block able to hold at least the given number of bytes
+     * @param  {bytes} std::size_t : minimum usable size of the new block
+     * @returns false if the system is out of memory
+     */
+    bool _grow(std::size_t bytes);
+
+public:
+    arena() {};
+    ~arena();
+
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    /**
+     * @brief  Makes sure the next allocations of up to the given bytes need no new block
+     * @param  {bytes} std::size_t : number of bytes to have available
+     */
+    bool reserve(std::size_t bytes);
+
+    /**
+     * @brief  Hands out memory from the arena
+     * @param  {bytes} std::size_t : size of the allocation
+     * @param  {align} std::size_t : alignment of the allocation (power of two, up to ARENA_ALIGNMENT)
+     * @returns The memory, or nullptr if the system is out of memory
+     */
+    void *alloc(std::size_t bytes, std::size_t align = ARENA_ALIGNMENT);
+
+    /**
+     * @brief  Total usable bytes across all blocks
+     */
+    std::size_t capacity() const;
+
+    /**
+     * @brief  Number of blocks requested from the system by every arena so far.
+     *         It stays constant while queries run on warmed up planners.
+     */
+    static std::uint64_t allocations() { return na.load(std::memory_order_relaxed); }
+};
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @brief Heuristic policies of the A_star search (see A_star::set_heuristic).
+ *        A policy prices straight and diagonal moves in fixed point and
+ *        estimates the cost between two cells from their distance along each
+ *        axis, with integer arithmetic only. Estimates never exceed the
+ *        cheapest path on an empty map with the policy's own move costs
+ *        (admissible), and differ by at most one move between neighbors
+ *        (consistent), so searches stay optimal.
+ */
+#ifndef A_STAR_HEURISTICS
+#define A_STAR_HEURISTICS
+
+#include <cstdint>
+
+/**
+ * @brief Distance between two coordinates along one axis, without wrapping around
+ */
+inline std::uint32_t heuristic_delta(std::uint32_t a, std::uint32_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+/**
+ * @brief Every move costs 1, diagonal or not: the estimate is the number of moves
+ */
+struct heuristic_chebyshev
+{
+    static constexpr std::uint16_t straight = 1, diagonal = 1;
+
+    static std::uint32_t distance(std::uint32_t dx, std::uint32_t dy) { return dx > dy ? dx : dy; }
+};
+
+/**
+ * @brief A diagonal move costs two straight ones, as on a 4-connected grid
+ */
+struct heuristic_manhattan
+{
+    static constexpr std::uint16_t straight = 1, diagonal = 2;
+
+    static std::uint32_t distance(std::uint32_t dx, std::uint32_t dy) { return dx + dy; }
+};
+
+/**
+ * @brief Straight moves cost 10 and diagonal ones 14, about 10 * sqrt(2):
+ *        the estimate walks the diagonal first, then straight
+ */
+struct heuristic_octile
+{
+    static constexpr std::uint16_t straight = 10, diagonal = 14;
+
+    static std::uint32_t distance(std::uint32_t dx, std::uint32_t dy)
+    {
+        std::uint32_t low = dx < dy ? dx : dy;
+        return 10 * (dx + dy) - 6 * low;
+    }
+};
+
+/**
+ * @brief Same moves as heuristic_octile, estimated by the straight line.
+ *        14 is a little below 10 * sqrt(2), so the line is scaled by
+ *        sqrt(98) instead of 10 to price a pure diagonal at exactly 14 a move.
+ */
+struct heuristic_euclidean
+{
+    static constexpr std::uint16_t straight = 10, diagonal = 14;
+
+    static std::uint32_t distance(std::uint32_t dx, std::uint32_t dy)
+    {
+        std::uint64_t n = 98 * (std::uint64_t(dx) * dx + std::uint64_t(dy) * dy);
+
+        if (n == 0)
+            return 0;
+
+        // Square root, one bit of the result per round from the highest even bit of n
+        std::uint64_t root = 0, bit;
+#if defined(__GNUC__)
+        bit = std::uint64_t(1) << ((63 - __builtin_clzll(n)) & ~1);
+#else
+        for (bit = std::uint64_t(1) << 62; bit > n; bit >>= 2)
+            ;
+#endif
+        for (; bit != 0; bit >>= 2)
+        {
+            std::uint64_t trial = root + bit;
+            std::uint64_t take = n >= trial ? ~std::uint64_t(0) : 0;
+            n -= trial & take;
+            root = (root >> 1) + (bit & take);
+        }
+        return static_cast<std::uint32_t>(root);
+    }
+};
+
+#endif
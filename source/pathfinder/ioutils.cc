@@ -1,19 +1,102 @@
 #include "ioutils.hh"
 #include <stdio.h>
 
-void cout_err(const char *tag, const char *details)
+#include <atomic>
+#include <mutex>
+
+/**
+ * Bounded multi-producer ring (sequence numbered slots). A slot whose
+ * sequence equals the write position is free, one past it holds a message.
+ * Sequences are stored relative to the slot index so that the zero
+ * initialized array starts out with every slot free.
+ */
+struct ioutils_slot
+{
+    std::atomic<std::uint64_t> seq; // Sequence minus the slot index
+    int level;
+    const char *tag;
+    const char *details;
+};
+
+static ioutils_slot ring[IOUTILS_RING_SIZE];
+static std::atomic<std::uint64_t> head{0}; // Next position to write
+static std::uint64_t tail = 0;             // Next position to flush, guarded by flushing
+static std::atomic<std::uint64_t> dropped{0};
+static std::mutex flushing;
+
+static_assert((IOUTILS_RING_SIZE & (IOUTILS_RING_SIZE - 1)) == 0, "IOUTILS_RING_SIZE must be a power of two");
+
+void ioutils_push(int level, const char *tag, const char *details)
+{
+    std::uint64_t pos = head.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        std::uint64_t i = pos & (IOUTILS_RING_SIZE - 1);
+        ioutils_slot &slot = ring[i];
+        std::int64_t diff = static_cast<std::int64_t>(slot.seq.load(std::memory_order_acquire) + i - pos);
+
+        if (diff == 0)
+        {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot.level = level;
+                slot.tag = tag;
+                slot.details = details;
+                slot.seq.store(pos + 1 - i, std::memory_order_release);
+                return;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Full: never block the caller, the count tells how much was lost
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void ioutils_flush()
 {
-    printf("ERROR (%s): %s\n", tag, details);
+    std::lock_guard<std::mutex> lock(flushing);
+
+    for (;;)
+    {
+        std::uint64_t i = tail & (IOUTILS_RING_SIZE - 1);
+        ioutils_slot &slot = ring[i];
+
+        if (slot.seq.load(std::memory_order_acquire) + i != tail + 1)
+            break;
+
+        switch (slot.level)
+        {
+        case IOUTILS_LEVEL_ERR:
+            printf("ERROR (%s): %s\n", slot.tag, slot.details);
+            break;
+        case IOUTILS_LEVEL_WARN:
+            printf("WARNING (%s): %s\n", slot.tag, slot.details);
+            break;
+        default:
+            printf("INFO (%s): %s\n", slot.tag, slot.details);
+            break;
+        }
+
+        slot.seq.store(tail + IOUTILS_RING_SIZE - i, std::memory_order_release);
+        tail++;
+    }
 }
 
-void cout_warn(const char *tag, const char *details)
+std::uint64_t ioutils_dropped()
 {
-#ifdef LOW_VERBOSE_MODE
-    printf("WARNING (%s): %s\n", tag, details);
-#endif
+    return dropped.load(std::memory_order_relaxed);
 }
 
-void cout_debug(const char *tag, const char *details)
+// Whatever is still in the ring when the program ends gets written out
+static struct ioutils_exit_flush
 {
-    printf("INFO (%s): %s\n", tag, details);
-}
\ No newline at end of file
+    ~ioutils_exit_flush() { ioutils_flush(); }
+} exit_flush;
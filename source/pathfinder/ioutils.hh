@@ -1,8 +1,64 @@
 #ifndef IOUTILS_H
 #define IOUTILS_H
 
-void cout_err(const char* tag, const char* details);
-void cout_warn(const char* tag, const char* details);
-void cout_debug(const char* tag, const char* details);
+/**
+ * Log levels, fixed at compile time through IOUTILS_LOG_LEVEL. Calls below
+ * the threshold are empty inline functions and compile away entirely. The
+ * others only record the message in a lock-free ring buffer; nothing is
+ * written out until ioutils_flush() is called (and once more at exit).
+ *
+ * tag and details are stored as pointers, so they must outlive the next
+ * flush (string literals do).
+ */
+#define IOUTILS_LEVEL_DEBUG 0
+#define IOUTILS_LEVEL_WARN 1
+#define IOUTILS_LEVEL_ERR 2
+#define IOUTILS_LEVEL_OFF 3
 
-#endif
\ No newline at end of file
+#ifndef IOUTILS_LOG_LEVEL
+#define IOUTILS_LOG_LEVEL IOUTILS_LEVEL_WARN
+#endif
+
+// Messages kept between two flushes (power of two), later ones are dropped
+#define IOUTILS_RING_SIZE 1024
+
+#include <cstdint>
+
+/**
+ * @brief Records a message in the ring buffer, safe to call from any thread
+ * @param  {level} int : IOUTILS_LEVEL_* of the message
+ * @param  {tag} const char* : where the message comes from
+ * @param  {details} const char* : the message
+ */
+void ioutils_push(int level, const char *tag, const char *details);
+
+/**
+ * @brief Writes every recorded message to stdout. Call it off the hot path,
+ *        only one thread flushes at a time.
+ */
+void ioutils_flush();
+
+/**
+ * @brief Number of messages dropped because the ring buffer was full
+ */
+std::uint64_t ioutils_dropped();
+
+inline void cout_err(const char *tag, const char *details)
+{
+    if constexpr (IOUTILS_LOG_LEVEL <= IOUTILS_LEVEL_ERR)
+        ioutils_push(IOUTILS_LEVEL_ERR, tag, details);
+}
+
+inline void cout_warn(const char *tag, const char *details)
+{
+    if constexpr (IOUTILS_LOG_LEVEL <= IOUTILS_LEVEL_WARN)
+        ioutils_push(IOUTILS_LEVEL_WARN, tag, details);
+}
+
+inline void cout_debug(const char *tag, const char *details)
+{
+    if constexpr (IOUTILS_LOG_LEVEL <= IOUTILS_LEVEL_DEBUG)
+        ioutils_push(IOUTILS_LEVEL_DEBUG, tag, details);
+}
+
+#endif
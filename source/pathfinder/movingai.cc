@@ -0,0 +1,104 @@
+#include "movingai.hh"
+#include "ioutils.hh"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+std::unique_ptr<A_star> movingai_load_map(const char *path)
+{
+    std::FILE *file = std::fopen(path, "r");
+    if (file == nullptr)
+    {
+        cout_err("movingai_load_map", "could not open the map file");
+        return nullptr;
+    }
+
+    // Header lines "key value" in any order, up to the line "map"
+    char key[32];
+    std::uint32_t width = 0, height = 0;
+    bool header = false;
+    while (std::fscanf(file, "%31s", key) == 1)
+    {
+        if (std::strcmp(key, "map") == 0)
+        {
+            header = true;
+            break;
+        }
+
+        char value[32];
+        if (std::fscanf(file, "%31s", value) != 1)
+            break;
+        if (std::strcmp(key, "width") == 0)
+            width = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(key, "height") == 0)
+            height = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+    }
+
+    if (!header || width == 0 || height == 0)
+    {
+        cout_err("movingai_load_map", "bad map header");
+        std::fclose(file);
+        return nullptr;
+    }
+
+    std::unique_ptr<A_star> planner(new A_star(width, height));
+    std::uint64_t cells = std::uint64_t(width) * height, read = 0;
+    for (int c; read < cells && (c = std::fgetc(file)) != EOF;)
+    {
+        // Rows are one line each, line ends are skipped along with any other space
+        if (std::isspace(c))
+            continue;
+
+        if (c != '.' && c != 'G' && c != 'S')
+            planner->toggletile(static_cast<std::uint32_t>(read % width), static_cast<std::uint32_t>(read / width), false);
+        read++;
+    }
+    std::fclose(file);
+
+    if (read != cells)
+    {
+        cout_err("movingai_load_map", "truncated map file");
+        return nullptr;
+    }
+    return planner;
+}
+
+bool movingai_load_scen(const char *path, std::vector<movingai_query> &queries)
+{
+    std::FILE *file = std::fopen(path, "r");
+    if (file == nullptr)
+    {
+        cout_err("movingai_load_scen", "could not open the scenario file");
+        return false;
+    }
+
+    double version = 0;
+    if (std::fscanf(file, " version %lf", &version) != 1 || version != 1)
+    {
+        cout_err("movingai_load_scen", "unsupported scenario version");
+        std::fclose(file);
+        return false;
+    }
+
+    queries.clear();
+    movingai_query q;
+    char map[4096];
+    while (std::fscanf(file, "%u %4095s %u %u %u %u %u %u %lf", &q.bucket, map, &q.width, &q.height, &q.sx, &q.sy,
+                       &q.tx, &q.ty, &q.optimal) == 9)
+    {
+        q.map = map;
+        queries.push_back(q);
+    }
+
+    bool complete = std::feof(file) != 0;
+    std::fclose(file);
+
+    if (!complete)
+    {
+        cout_err("movingai_load_scen", "bad scenario line");
+        return false;
+    }
+    return true;
+}
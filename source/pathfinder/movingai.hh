@@ -0,0 +1,46 @@
+/**
+ * @brief Readers for the grid benchmark formats of the Moving AI Lab
+ *        (https://movingai.com/benchmarks/formats.html): .map files build a
+ *        planner, .scen files list queries with their optimal lengths.
+ */
+#ifndef MOVINGAI_ROBALGOR
+#define MOVINGAI_ROBALGOR
+
+#include "a_star.hh"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * A query of a .scen file. The optimal length is the octile distance, with
+ * diagonal moves of length sqrt(2) that may not cut corners; A_star lets
+ * diagonals cut corners, so its paths can come out a little shorter.
+ */
+struct movingai_query
+{
+    std::uint32_t bucket;        // Difficulty bucket, optimal length / 4 on the published sets
+    std::string map;             // Map file, as written in the scenario
+    std::uint32_t width, height; // Resolution of the map
+    std::uint32_t sx, sy, tx, ty;
+    double optimal;              // Optimal path length
+};
+
+/**
+ * @brief  Builds a planner from a .map file. '.', 'G' and 'S' (swamp) are
+ *         free, every other terrain ('@', 'O', 'T', 'W') is blocked.
+ * @param  {path} const char* : .map file
+ * @returns The planner, null if the file cannot be read
+ */
+std::unique_ptr<A_star> movingai_load_map(const char *path);
+
+/**
+ * @brief  Reads the queries of a .scen file (version 1)
+ * @param  {path} const char* : .scen file
+ * @param  {queries} std::vector<movingai_query>& : receives the queries, in file order
+ * @returns false if the file cannot be read
+ */
+bool movingai_load_scen(const char *path, std::vector<movingai_query> &queries);
+
+#endif
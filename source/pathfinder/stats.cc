@@ -0,0 +1,98 @@
+#include "stats.hh"
+
+#include <algorithm>
+
+std::uint32_t stats_histogram::_bucket(std::uint64_t value)
+{
+    if (value < STATS_SUB_BUCKETS)
+        return static_cast<std::uint32_t>(value);
+
+    // The two bits below the highest set one pick the sub-bucket
+    std::uint32_t e = 63 - static_cast<std::uint32_t>(__builtin_clzll(value));
+    std::uint32_t sub = static_cast<std::uint32_t>(value >> (e - 2)) & (STATS_SUB_BUCKETS - 1);
+    return STATS_SUB_BUCKETS * (e - 1) + sub;
+}
+
+std::uint64_t stats_histogram::_upper(std::uint32_t bucket)
+{
+    if (bucket < STATS_SUB_BUCKETS)
+        return bucket;
+
+    std::uint32_t e = bucket / STATS_SUB_BUCKETS + 1, sub = bucket % STATS_SUB_BUCKETS;
+    // The last bucket ends at the largest 64 bit value, its end would not fit
+    if (e == 63 && sub == STATS_SUB_BUCKETS - 1)
+        return ~std::uint64_t(0);
+    return ((std::uint64_t(STATS_SUB_BUCKETS + sub + 1)) << (e - 2)) - 1;
+}
+
+void stats_histogram::_record(metric m, std::uint64_t value)
+{
+    this->buckets[m][_bucket(value)]++;
+    this->hi[m] = std::max(this->hi[m], value);
+}
+
+void stats_histogram::add(const A_star::stats &s)
+{
+    _record(latency_ns, s.search_ns + s.path_ns);
+    _record(expanded, s.expanded);
+    _record(pushed, s.pushed);
+    _record(peak_open, s.peak_open);
+    this->n++;
+}
+
+void stats_histogram::merge(const stats_histogram &other)
+{
+    for (std::uint32_t m = 0; m < metrics; m++)
+    {
+        for (std::uint32_t b = 0; b < STATS_BUCKETS; b++)
+            this->buckets[m][b] += other.buckets[m][b];
+        this->hi[m] = std::max(this->hi[m], other.hi[m]);
+    }
+    this->n += other.n;
+}
+
+std::uint64_t stats_histogram::percentile(metric m, double p) const
+{
+    if (this->n == 0)
+        return 0;
+
+    // Rank of the percentile, 1 based
+    std::uint64_t rank = static_cast<std::uint64_t>(p * this->n + 0.5);
+    rank = std::min(std::max<std::uint64_t>(rank, 1), this->n);
+
+    std::uint64_t seen = 0;
+    for (std::uint32_t b = 0; b < STATS_BUCKETS; b++)
+    {
+        seen += this->buckets[m][b];
+        if (seen >= rank)
+            return std::min(_upper(b), this->hi[m]);
+    }
+    return this->hi[m];
+}
+
+void stats_histogram::export_json(std::FILE *out) const
+{
+    static const char *names[metrics] = {"latency_ns", "expanded", "pushed", "peak_open"};
+
+    std::fprintf(out, "{\"count\": %llu", static_cast<unsigned long long>(this->n));
+    for (std::uint32_t m = 0; m < metrics; m++)
+    {
+        metric k = static_cast<metric>(m);
+        std::fprintf(out, ",\n \"%s\": {\"max\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"buckets\": [",
+                     names[m], static_cast<unsigned long long>(this->hi[m]),
+                     static_cast<unsigned long long>(percentile(k, 0.5)), static_cast<unsigned long long>(percentile(k, 0.9)),
+                     static_cast<unsigned long long>(percentile(k, 0.99)), static_cast<unsigned long long>(percentile(k, 0.999)));
+
+        bool first = true;
+        for (std::uint32_t b = 0; b < STATS_BUCKETS; b++)
+        {
+            if (this->buckets[m][b] == 0)
+                continue;
+            std::fprintf(out, "%s[%llu, %llu]", first ? "" : ", ", static_cast<unsigned long long>(_upper(b)),
+                         static_cast<unsigned long long>(this->buckets[m][b]));
+            first = false;
+        }
+        std::fprintf(out, "]}");
+    }
+    std::fprintf(out, "}\n");
+}
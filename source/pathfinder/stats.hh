@@ -0,0 +1,91 @@
+/**
+ * @brief Histograms of A_star::stats over many searches, to find the slow
+ *        queries of a fleet rather than its average
+ */
+#ifndef STATS_ROBALGOR
+#define STATS_ROBALGOR
+
+// Buckets per power of two, values below it get a bucket each
+#define STATS_SUB_BUCKETS 4
+// Buckets of every histogram, enough for any 64 bit value
+#define STATS_BUCKETS 256
+
+#include "a_star.hh"
+
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * Log-linear histograms, like HDR histograms at two bits of precision: a
+ * value v >= 4 falls in one of the 4 buckets splitting [2^e, 2^(e+1)),
+ * e = floor(log2 v), so a bucket is never wider than a quarter of its
+ * values. Adding is a handful of instructions and never allocates.
+ * Histograms are not thread safe; keep one per thread and merge them.
+ */
+class stats_histogram
+{
+public:
+    // Statistics with a histogram
+    enum metric
+    {
+        latency_ns, // search_ns + path_ns
+        expanded,
+        pushed,
+        peak_open,
+        metrics
+    };
+
+    /**
+     * @brief Adds the statistics of one search
+     */
+    void add(const A_star::stats &s);
+
+    /**
+     * @brief Adds every search recorded by another histogram
+     */
+    void merge(const stats_histogram &other);
+
+    /**
+     * @brief Number of searches recorded
+     */
+    std::uint64_t count() const { return this->n; }
+
+    /**
+     * @brief  Value under which a share of the searches fall
+     * @param  {m} metric : statistic
+     * @param  {p} double : share, 0 to 1 (0.99 for the 99th percentile)
+     * @returns The upper bound of the bucket holding that percentile, 0 if nothing was recorded
+     */
+    std::uint64_t percentile(metric m, double p) const;
+
+    /**
+     * @brief  Largest value recorded
+     */
+    std::uint64_t max(metric m) const { return this->hi[m]; }
+
+    /**
+     * @brief  Writes every histogram as JSON: count, then for every metric its
+     *         max, p50/p90/p99/p999 and the non-empty buckets as [upper bound, count]
+     * @param  {out} std::FILE* : stream to write to
+     */
+    void export_json(std::FILE *out) const;
+
+private:
+    std::uint64_t buckets[metrics][STATS_BUCKETS] = {};
+    std::uint64_t hi[metrics] = {};
+    std::uint64_t n = 0;
+
+    /**
+     * @brief Bucket of a value
+     */
+    static std::uint32_t _bucket(std::uint64_t value);
+
+    /**
+     * @brief Largest value of a bucket
+     */
+    static std::uint64_t _upper(std::uint32_t bucket);
+
+    void _record(metric m, std::uint64_t value);
+};
+
+#endif
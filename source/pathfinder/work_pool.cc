@@ -0,0 +1,140 @@
+#include "work_pool.hh"
+
+static std::uint64_t _span(std::uint32_t begin, std::uint32_t end)
+{
+    return static_cast<std::uint64_t>(end) << 32 | begin;
+}
+
+work_pool::work_pool(std::uint32_t workers) : ranges(workers > 0 ? workers : 1)
+{
+    for (std::uint32_t i = 1; i < this->ranges.size(); i++)
+        this->threads.emplace_back(&work_pool::_loop, this, i);
+}
+
+work_pool::~work_pool()
+{
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->stop = true;
+    }
+    this->wake.notify_all();
+
+    for (std::thread &t : this->threads)
+        t.join();
+}
+
+void work_pool::run(std::uint32_t count, task fn, void *arg)
+{
+    std::uint32_t workers = size();
+
+    // Even split, the first count % workers ranges get one index more
+    std::uint32_t begin = 0;
+    for (std::uint32_t i = 0; i < workers; i++)
+    {
+        std::uint32_t end = begin + count / workers + (i < count % workers ? 1 : 0);
+        this->ranges[i].span.store(_span(begin, end), std::memory_order_relaxed);
+        begin = end;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->fn = fn;
+        this->arg = arg;
+        this->active = workers - 1;
+        this->epoch++;
+    }
+    this->wake.notify_all();
+
+    _work(0);
+
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->done.wait(guard, [this] { return this->active == 0; });
+}
+
+void work_pool::_loop(std::uint32_t worker)
+{
+    std::uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> guard(this->lock);
+            this->wake.wait(guard, [&] { return this->stop || this->epoch != seen; });
+            if (this->stop)
+                return;
+            seen = this->epoch;
+        }
+
+        _work(worker);
+
+        std::lock_guard<std::mutex> guard(this->lock);
+        if (--this->active == 0)
+            this->done.notify_one();
+    }
+}
+
+void work_pool::_work(std::uint32_t worker)
+{
+    std::uint32_t index;
+    do
+    {
+        while (_take(worker, index))
+            this->fn(this->arg, worker, index);
+    } while (_steal(worker));
+}
+
+bool work_pool::_take(std::uint32_t worker, std::uint32_t &index)
+{
+    std::atomic<std::uint64_t> &span = this->ranges[worker].span;
+    std::uint64_t current = span.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        std::uint32_t begin = static_cast<std::uint32_t>(current), end = static_cast<std::uint32_t>(current >> 32);
+        if (begin >= end)
+            return false;
+
+        if (span.compare_exchange_weak(current, _span(begin + 1, end), std::memory_order_acq_rel))
+        {
+            index = begin;
+            return true;
+        }
+    }
+}
+
+bool work_pool::_steal(std::uint32_t worker)
+{
+    for (;;)
+    {
+        // Fullest victim first, it is the least likely to run dry while we steal
+        std::uint32_t victim = worker, most = 0;
+        std::uint64_t seen = 0;
+        for (std::uint32_t i = 0; i < size(); i++)
+        {
+            std::uint64_t current = this->ranges[i].span.load(std::memory_order_acquire);
+            std::uint32_t left = static_cast<std::uint32_t>(current >> 32) - static_cast<std::uint32_t>(current);
+            if (i != worker && static_cast<std::uint32_t>(current) < static_cast<std::uint32_t>(current >> 32) && left > most)
+            {
+                victim = i;
+                most = left;
+                seen = current;
+            }
+        }
+
+        if (victim == worker)
+            return false;
+
+        // The thief takes the back half of the indices the victim has not claimed yet, or the only one left:
+        // the index the victim is running already left its range in _take
+        std::uint32_t begin = static_cast<std::uint32_t>(seen), end = static_cast<std::uint32_t>(seen >> 32);
+        std::uint32_t split = end - most / 2;
+        if (split == end)
+            split = begin;
+
+        if (this->ranges[victim].span.compare_exchange_strong(seen, _span(begin, split), std::memory_order_acq_rel))
+        {
+            // Only the owner takes from its range, and thieves skip it while it is empty
+            this->ranges[worker].span.store(_span(split, end), std::memory_order_release);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/**
+ * @brief Work-stealing thread pool running index ranges in parallel
+ */
+#ifndef WORK_POOL_ROBALGOR
+#define WORK_POOL_ROBALGOR
+
+// Size (in bytes) each worker's range is padded to, so workers do not share cache lines
+#define WORK_POOL_LINE 64
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs a function over every index of [0, count) on a fixed set of threads,
+ * the caller being worker 0. Indices are split into one contiguous range
+ * per worker; a worker takes indices from the front of its own range and,
+ * once it is empty, steals the back half of the fullest range it finds.
+ * A range is a single 64 bit word (begin in the low half, end in the high
+ * half), so both take and steal are one compare-and-swap.
+ */
+class work_pool
+{
+public:
+    /**
+     * @brief Function run for every index
+     * @param  {arg} void* : argument given to work_pool::run
+     * @param  {worker} std::uint32_t : worker running it, 0 to size() - 1
+     * @param  {index} std::uint32_t : index of the item
+     */
+    typedef void (*task)(void *arg, std::uint32_t worker, std::uint32_t index);
+
+private:
+    struct alignas(WORK_POOL_LINE) range
+    {
+        std::atomic<std::uint64_t> span{0};
+    };
+
+    std::vector<std::thread> threads; // Helpers, worker i + 1 runs on threads[i]
+    std::vector<range> ranges;        // Remaining indices of every worker
+
+    std::mutex lock;
+    std::condition_variable wake, done;
+    std::uint64_t epoch = 0;  // Bumped by every call to run
+    std::uint32_t active = 0; // Helpers still working on the current epoch
+    bool stop = false;
+
+    task fn = nullptr;
+    void *arg = nullptr;
+
+    /**
+     * @brief Body of a helper thread, waits for epochs until the pool is destroyed
+     */
+    void _loop(std::uint32_t worker);
+
+    /**
+     * @brief Runs indices until every range is empty
+     */
+    void _work(std::uint32_t worker);
+
+    /**
+     * @brief Takes the next index of a worker's own range
+     * @returns false if the range is empty
+     */
+    bool _take(std::uint32_t worker, std::uint32_t &index);
+
+    /**
+     * @brief Moves the back half of the fullest other range into a worker's own range
+     * @returns false if there was nothing left to steal
+     */
+    bool _steal(std::uint32_t worker);
+
+public:
+    /**
+     * @param  {workers} std::uint32_t : number of workers, the calling thread included
+     */
+    explicit work_pool(std::uint32_t workers);
+    ~work_pool();
+
+    work_pool(const work_pool &) = delete;
+    work_pool &operator=(const work_pool &) = delete;
+
+    /**
+     * @brief  Runs fn(arg, worker, index) for every index in [0, count) and
+     *         returns once all of them are done. Not reentrant.
+     */
+    void run(std::uint32_t count, task fn, void *arg);
+
+    /**
+     * @brief  Number of workers, the calling thread included
+     */
+    std::uint32_t size() const { return static_cast<std::uint32_t>(this->ranges.size()); }
+};
+
+#endif
@@ -0,0 +1,218 @@
+/**
+ * @brief Runs Moving AI scenario files (.scen) against the planner and
+ *        reports, per file: latency percentiles, nodes expanded, path length
+ *        against the optimal one of the scenario, and throughput.
+ *
+ *        A_star_scenarios [--json] [--maps DIR] [--heuristic chebyshev|octile] FILE.scen...
+ *
+ *        Maps are looked up by file name in DIR, by default the directory of
+ *        the scenario. Lengths are measured with diagonals of sqrt(2), like
+ *        the optimal ones; the planner lets diagonals cut corners, so ratios
+ *        slightly below 1 are expected.
+ */
+#include "benchmarks/bench_utils.hh"
+#include "pathfinder/a_star.hh"
+#include "pathfinder/movingai.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Outcome of one scenario file
+struct scenario_report
+{
+    std::string file;
+    std::uint32_t queries = 0, solved = 0, suboptimal = 0;
+    double p50 = 0, p90 = 0, p99 = 0, max = 0, mean = 0; // Latency, microseconds
+    double expanded = 0;                                 // Mean nodes expanded per query
+    double ratio = 0;                                    // Sum of path lengths over sum of optimal lengths, solved queries
+    double throughput = 0;                               // Queries per second
+};
+
+static std::string base_name(const std::string &path)
+{
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static std::string dir_name(const std::string &path)
+{
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? "." : path.substr(0, slash);
+}
+
+static double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    std::size_t i = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<std::size_t>(i, 1)) - 1];
+}
+
+// Length of a path, diagonal moves counting sqrt(2)
+static double path_length(const std::vector<A_star::point> &path, std::uint32_t length)
+{
+    std::uint32_t straight = 0, diagonal = 0;
+    for (std::uint32_t i = 1; i < length; i++)
+    {
+        if (path[i].x != path[i - 1].x && path[i].y != path[i - 1].y)
+            diagonal++;
+        else
+            straight++;
+    }
+    return straight + diagonal * std::sqrt(2.0);
+}
+
+static bool run_scenario(const char *file, const std::string &maps, std::uint8_t heuristic, scenario_report &report)
+{
+    std::vector<movingai_query> queries;
+    if (!movingai_load_scen(file, queries))
+        return false;
+
+    report.file = file;
+    std::string dir = maps.empty() ? dir_name(file) : maps;
+
+    std::map<std::string, std::unique_ptr<A_star>> planners;
+    std::vector<A_star::point> path;
+    std::vector<double> latency;
+    std::uint64_t expanded = 0;
+    double found = 0, optimal = 0, busy = 0;
+
+    for (const movingai_query &q : queries)
+    {
+        std::unique_ptr<A_star> &planner = planners[q.map];
+        if (planner == nullptr)
+        {
+            std::string map = dir + "/" + base_name(q.map);
+            planner = movingai_load_map(map.c_str());
+            if (planner == nullptr || !planner->set_heuristic(heuristic))
+            {
+                std::fprintf(stderr, "%s: could not load %s\n", file, map.c_str());
+                return false;
+            }
+        }
+
+        path.resize(std::size_t(q.width) * q.height);
+        bench_timer t;
+        std::uint32_t length = planner->run(q.sx, q.sy, q.tx, q.ty, path.data(), static_cast<std::uint32_t>(path.size()));
+        double elapsed = t.seconds();
+
+        busy += elapsed;
+        latency.push_back(elapsed * 1e6);
+        expanded += planner->expanded();
+        report.queries++;
+
+        if (length == 0)
+            continue;
+
+        double l = path_length(path, length);
+        report.solved++;
+        found += l;
+        optimal += q.optimal;
+        if (l > q.optimal + 1e-3)
+            report.suboptimal++;
+    }
+
+    std::sort(latency.begin(), latency.end());
+    report.p50 = percentile(latency, 0.50);
+    report.p90 = percentile(latency, 0.90);
+    report.p99 = percentile(latency, 0.99);
+    report.max = latency.empty() ? 0 : latency.back();
+    report.mean = report.queries != 0 ? busy * 1e6 / report.queries : 0;
+    report.expanded = report.queries != 0 ? double(expanded) / report.queries : 0;
+    report.ratio = optimal > 0 ? found / optimal : 0;
+    report.throughput = busy > 0 ? report.queries / busy : 0;
+    return true;
+}
+
+static void print_json_string(const std::string &s)
+{
+    std::putchar('"');
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            std::putchar('\\');
+        std::putchar(c);
+    }
+    std::putchar('"');
+}
+
+static void print_json(const std::vector<scenario_report> &reports)
+{
+    std::printf("{\"scenarios\": [");
+    for (std::size_t i = 0; i < reports.size(); i++)
+    {
+        const scenario_report &r = reports[i];
+        std::printf("%s\n  {\"file\": ", i == 0 ? "" : ",");
+        print_json_string(r.file);
+        std::printf(", \"queries\": %u, \"solved\": %u, \"suboptimal\": %u,\n", r.queries, r.solved, r.suboptimal);
+        std::printf("   \"latency_us\": {\"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f, \"mean\": %.3f},\n",
+                    r.p50, r.p90, r.p99, r.max, r.mean);
+        std::printf("   \"expanded_mean\": %.1f, \"length_ratio\": %.6f, \"queries_per_second\": %.1f}", r.expanded, r.ratio,
+                    r.throughput);
+    }
+    std::printf("\n]}\n");
+}
+
+int main(int argc, char **argv)
+{
+    bool json = false;
+    std::string maps;
+    std::uint8_t heuristic = A_STAR_HEURISTIC_OCTILE;
+    std::vector<const char *> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--json") == 0)
+            json = true;
+        else if (std::strcmp(argv[i], "--maps") == 0 && i + 1 < argc)
+            maps = argv[++i];
+        else if (std::strcmp(argv[i], "--heuristic") == 0 && i + 1 < argc)
+        {
+            i++;
+            if (std::strcmp(argv[i], "chebyshev") == 0)
+                heuristic = A_STAR_HEURISTIC_CHEBYSHEV;
+            else if (std::strcmp(argv[i], "octile") != 0)
+            {
+                std::fprintf(stderr, "unknown heuristic %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else
+            files.push_back(argv[i]);
+    }
+
+    if (files.empty())
+    {
+        std::fprintf(stderr, "usage: %s [--json] [--maps DIR] [--heuristic chebyshev|octile] FILE.scen...\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<scenario_report> reports;
+    for (const char *file : files)
+    {
+        scenario_report report;
+        if (!run_scenario(file, maps, heuristic, report))
+            return 1;
+        reports.push_back(report);
+    }
+
+    if (json)
+    {
+        print_json(reports);
+        return 0;
+    }
+
+    std::printf("%-24s %8s %8s %10s %10s %10s %10s %12s %8s %12s\n", "scenario", "queries", "solved", "p50 us", "p90 us",
+                "p99 us", "max us", "expanded", "ratio", "queries/s");
+    for (const scenario_report &r : reports)
+        std::printf("%-24s %8u %8u %10.1f %10.1f %10.1f %10.1f %12.0f %8.4f %12.1f\n", base_name(r.file).c_str(), r.queries,
+                    r.solved, r.p50, r.p90, r.p99, r.max, r.expanded, r.ratio, r.throughput);
+    return 0;
+}